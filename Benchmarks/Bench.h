@@ -0,0 +1,59 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <vector>
+
+// Shared by every benchmark case.  Each case builds its own data, times the
+// variants it compares with measureMs and prints one line per variant with
+// report.
+struct BenchOptions
+{
+	// Small sizes and a single run, to check the cases still work.
+	bool Quick = false;
+
+	// Picks the full or the quick size of something.
+	std::size_t size(std::size_t full, std::size_t quick) const { return Quick ? quick : full; }
+	int runs(int full) const { return Quick ? 1 : full; }
+};
+
+// Runs fn once to warm up, then runs times, and returns the median time of
+// one run in milliseconds.
+template<typename Fn>
+double measureMs(int runs, Fn fn)
+{
+	fn();
+
+	std::vector<double> times;
+	times.reserve(runs);
+	for (int i = 0; i < runs; ++i)
+	{
+		auto start = std::chrono::steady_clock::now();
+		fn();
+		auto end = std::chrono::steady_clock::now();
+		times.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+	}
+
+	std::sort(times.begin(), times.end());
+	return times[times.size() / 2];
+}
+
+// Writes one "case,variant,ms,detail" line.
+void report(const char* benchCase, const std::string& variant, double ms, const std::string& detail = std::string());
+
+// Keeps a result alive so the work that produced it is not optimised away.
+void keep(double value);
+
+// The cases, named after the change they measure.
+void benchCachedTransforms(const BenchOptions& options);
+void benchParallelUpdate(const BenchOptions& options);
+void benchFrameContext(const BenchOptions& options);
+void benchDetach(const BenchOptions& options);
+void benchDrawRecord(const BenchOptions& options);
+void benchDirtyUpload(const BenchOptions& options);
+void benchStreamConstants(const BenchOptions& options);
+void benchSceneFrame(const BenchOptions& options);
+void benchWavesThreads(const BenchOptions& options);
+void benchWavesStencil(const BenchOptions& options);
+void benchWavesSleep(const BenchOptions& options);
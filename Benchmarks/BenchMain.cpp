@@ -0,0 +1,83 @@
+#include "Bench.h"
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+
+// Runs the benchmark cases:
+//
+//     Benchmarks [--quick] [CASE...]
+//
+// With no case names every case runs.  A case is picked by its name or by the
+// id of the request it measures.
+
+namespace
+{
+	struct BenchCase
+	{
+		const char* Request;
+		const char* Name;
+		void (*Run)(const BenchOptions& options);
+	};
+
+	const BenchCase Cases[] = {
+		{ "user-001", "cached-transforms", benchCachedTransforms },
+		{ "user-004", "parallel-update", benchParallelUpdate },
+		{ "user-005", "frame-context", benchFrameContext },
+		{ "user-007", "detach", benchDetach },
+		{ "user-013", "draw-record", benchDrawRecord },
+		{ "user-016", "dirty-upload", benchDirtyUpload },
+		{ "user-017", "stream-constants", benchStreamConstants },
+		{ "user-020", "scene-frame", benchSceneFrame },
+		{ "user-021", "waves-threads", benchWavesThreads },
+		{ "user-022", "waves-stencil", benchWavesStencil },
+		{ "user-025", "waves-sleep", benchWavesSleep },
+	};
+
+	volatile double sKept = 0.0;
+}
+
+void report(const char* benchCase, const std::string& variant, double ms, const std::string& detail)
+{
+	std::cout << benchCase << ',' << variant << ',' << std::fixed << std::setprecision(4) << ms << ',' << detail << std::endl;
+}
+
+void keep(double value)
+{
+	sKept = sKept + value;
+}
+
+int main(int argc, char** argv)
+{
+	BenchOptions options;
+	std::vector<const char*> picked;
+	for (int i = 1; i < argc; ++i)
+	{
+		if (std::strcmp(argv[i], "--quick") == 0)
+			options.Quick = true;
+		else
+			picked.push_back(argv[i]);
+	}
+
+	std::cout << "case,variant,ms,detail\n";
+
+	int ran = 0;
+	for (const BenchCase& benchCase : Cases)
+	{
+		bool wanted = picked.empty();
+		for (const char* name : picked)
+			wanted = wanted || std::strcmp(name, benchCase.Name) == 0 || std::strcmp(name, benchCase.Request) == 0;
+
+		if (wanted)
+		{
+			benchCase.Run(options);
+			++ran;
+		}
+	}
+
+	if (ran == 0)
+	{
+		std::cerr << "no such case\n";
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,78 @@
+#include "Bench.h"
+#include "DrawQueue.h"
+#include "NullCommandRecorder.h"
+#include "RecordingCommandList.h"
+#include "ThreadPool.h"
+#include <sstream>
+
+namespace
+{
+	template<typename Handle>
+	Handle handle(std::uint32_t index)
+	{
+		Handle h;
+		h.Index = index;
+		return h;
+	}
+
+	// Three passes, the last blended, over a spread of pipelines, materials
+	// and meshes.  Every packet draws its own index range, so none merge and
+	// every packet is a draw.
+	void fillQueue(DrawQueue& queue, std::size_t count)
+	{
+		queue.clear();
+		queue.reserve(count);
+		for (std::uint32_t object = 0; object < count; ++object)
+		{
+			DrawQueue::Packet p;
+			p.Pass = object % 3;
+			p.BackToFront = p.Pass == 2;
+			p.Pso = handle<PsoHandle>(object % 8);
+			p.Material = handle<MaterialHandle>(object % 64);
+			p.Mesh = handle<MeshHandle>(object % 16);
+			p.Topology = 4;
+			p.Depth = (object % 1000) / 1000.0f;
+			p.ObjCBIndex = object;
+			p.IndexCount = 36;
+			p.StartIndexLocation = object * 36;
+			queue.add(p);
+		}
+		queue.sort();
+	}
+}
+
+void benchDrawRecord(const BenchOptions& options)
+{
+	const std::size_t count = options.size(100000, 2000);
+	const int runs = options.runs(9);
+
+	// As many packets per chunk as the scene records with.
+	const std::size_t packetsPerChunk = 256;
+
+	DrawQueue queue;
+	fillQueue(queue, count);
+
+	std::ostringstream detail;
+	detail << count << " packets";
+
+	RecordingCommandList single;
+	report("draw-record", "one-list", measureMs(runs, [&]()
+	{
+		single.clear();
+		keep(queue.submit(single).Draws);
+	}), detail.str());
+
+	for (unsigned threads : { 1u, 2u, 4u, 8u })
+	{
+		ThreadPool pool(threads);
+		NullCommandRecorder recorder(threads);
+		std::ostringstream variant;
+		variant << threads << (threads == 1 ? "-thread" : "-threads");
+
+		report("draw-record", variant.str(), measureMs(runs, [&]()
+		{
+			recorder.clear();
+			keep(queue.record(recorder, pool, packetsPerChunk).Draws);
+		}), detail.str());
+	}
+}
@@ -0,0 +1,38 @@
+#include "Bench.h"
+#include "NullRenderDevice.h"
+#include "Scene.h"
+#include <iomanip>
+#include <sstream>
+
+void benchSceneFrame(const BenchOptions& options)
+{
+	// Frames of one run each, so the median is that of single frames.
+	const int frames = options.runs(600);
+	const float frameTime = 1.0f / 60.0f;
+
+	// Stepped once per frame the way Headless steps it at 60Hz, and only
+	// updated and drawn, as between steps at higher frame rates.
+	for (bool step : { true, false })
+	{
+		Scene scene;
+		NullRenderDevice device(scene.GetThreadPool().threadCount());
+		scene.Build(device);
+
+		int frame = 0;
+		double ms = measureMs(frames, [&]()
+		{
+			++frame;
+			if (step)
+				scene.Step(frameTime);
+			scene.Update(frame * frameTime, frameTime, 1.0f);
+			scene.Draw();
+		});
+
+		// The hash is the same on every run with the same frame count, so a
+		// changed one means the scene no longer does the same work.
+		std::ostringstream detail;
+		detail << frame << " frames hash " << std::hex << std::setfill('0') << std::setw(16)
+			<< scene.HashRenderItems();
+		report("scene-frame", step ? "step-update-draw" : "update-draw", ms, detail.str());
+	}
+}
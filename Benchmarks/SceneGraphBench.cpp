@@ -0,0 +1,249 @@
+#include "Bench.h"
+#include "Entity.h"
+#include "FrameContext.h"
+#include "NodePool.h"
+#include "SceneNode.h"
+#include "ThreadPool.h"
+#include "TransformStore.h"
+#include <algorithm>
+#include <sstream>
+
+namespace
+{
+	// A 4-ary tree, built breadth first, so a 100k-node graph is nine levels
+	// deep.  Nodes are spaced out so no two world matrices are alike.
+	void buildTree(SceneNode& root, NodePool<SceneNode>& pool, TransformStore& store, std::size_t count,
+		std::vector<SceneNode*>& nodes)
+	{
+		pool.reserve(count);
+		store.reserve(count + 1);
+
+		nodes.clear();
+		nodes.reserve(count);
+		for (std::size_t i = 0; i < count; ++i)
+		{
+			SceneNode::Ptr node = pool.create(store);
+			node->setPosition(XMVectorSet((float)(i % 7), 0.1f, (float)(i % 5), 1.0f));
+			node->setRotation(XMQuaternionRotationRollPitchYaw(0.0f, 0.01f * (i % 11), 0.0f));
+
+			SceneNode* raw = node.get();
+			SceneNode& parent = i == 0 ? root : *nodes[(i - 1) / 4];
+			parent.attachChild(std::move(node));
+			nodes.push_back(raw);
+		}
+	}
+
+	// How world transforms were found before they were cached: every node
+	// composes its local transform with every ancestor's, every frame.
+	double walkParents(const std::vector<SceneNode*>& nodes)
+	{
+		double sum = 0.0;
+		for (const SceneNode* node : nodes)
+		{
+			XMMATRIX world = node->getTransform();
+			for (const SceneNode* parent = node->getParent(); parent != nullptr; parent = parent->getParent())
+				world = world * parent->getTransform();
+			sum += XMVectorGetX(world.r[3]);
+		}
+		return sum;
+	}
+
+	// The scene's layout scaled up: a root, two layer nodes and moving
+	// entities that each draw, split evenly between the layers.
+	struct EntityScene
+	{
+		TransformStore				Store;
+		NodePool<SceneNode>			LayerPool;
+		NodePool<Entity>			EntityPool;
+		SceneNode					Root;
+		ObjectTransforms			Objects;
+
+		explicit EntityScene(std::size_t count)
+			: Root(Store)
+			, Objects(3)
+		{
+			Store.reserve(count + 3);
+			EntityPool.reserve(count);
+			Objects.reserve(count);
+
+			SceneNode* layers[2];
+			for (SceneNode*& layer : layers)
+			{
+				SceneNode::Ptr node = LayerPool.create(Store);
+				layer = node.get();
+				layer->reserveChildren(count / 2 + 1);
+				Root.attachChild(std::move(node));
+			}
+
+			for (std::size_t i = 0; i < count; ++i)
+			{
+				NodePool<Entity>::Ptr entity = EntityPool.create(Store);
+				entity->setPosition(XMVectorSet((float)(i % 100), 0.0f, (float)(i / 100), 1.0f));
+				entity->setVelocity(0.5f, 0.0f, (i % 2) ? 1.0f : -1.0f);
+				entity->renderHandle = Objects.add(XMMatrixIdentity(), XMMatrixIdentity());
+
+				layers[i % 2]->attachChild(std::move(entity));
+			}
+			Store.updateWorldTransforms();
+		}
+
+		// One simulation step the way Scene::UpdateGameObjects takes it.
+		void step(const FrameContext& frame, ThreadPool& pool)
+		{
+			Objects.beginStep();
+			Store.integrate(frame.DeltaTime, pool);
+			Store.updateWorldTransforms(pool);
+
+			SceneNode::beginUpdate();
+			Root.updateParallel(frame, Objects, pool, 2);
+			pool.wait();
+			SceneNode::endUpdate();
+		}
+	};
+
+	double readCached(const std::vector<SceneNode*>& nodes)
+	{
+		double sum = 0.0;
+		for (const SceneNode* node : nodes)
+			sum += XMVectorGetX(node->getWorldTransform().r[3]);
+		return sum;
+	}
+}
+
+void benchCachedTransforms(const BenchOptions& options)
+{
+	const std::size_t count = options.size(100000, 2000);
+	const int runs = options.runs(9);
+
+	TransformStore store;
+	NodePool<SceneNode> pool;
+	SceneNode root(store);
+	std::vector<SceneNode*> nodes;
+	buildTree(root, pool, store, count, nodes);
+	store.updateWorldTransforms();
+
+	std::ostringstream detail;
+	detail << count << " nodes";
+
+	report("cached-transforms", "walk-parents", measureMs(runs, [&]() { keep(walkParents(nodes)); }), detail.str());
+
+	// One node in a hundred moves; only those and their subtrees are recomposed.
+	std::size_t frame = 0;
+	report("cached-transforms", "cached-1%-moved", measureMs(runs, [&]()
+	{
+		++frame;
+		for (std::size_t i = frame % 100; i < nodes.size(); i += 100)
+			nodes[i]->move(XMVectorSet(0.001f, 0.0f, 0.0f, 0.0f));
+		store.updateWorldTransforms();
+		keep(readCached(nodes));
+	}), detail.str());
+
+	// Moving the root dirties everything: the worst case for the cache.
+	report("cached-transforms", "cached-all-moved", measureMs(runs, [&]()
+	{
+		nodes[0]->move(XMVectorSet(0.001f, 0.0f, 0.0f, 0.0f));
+		store.updateWorldTransforms();
+		keep(readCached(nodes));
+	}), detail.str());
+}
+
+void benchParallelUpdate(const BenchOptions& options)
+{
+	const std::size_t count = options.size(100000, 2000);
+	const int runs = options.runs(9);
+
+	EntityScene scene(count);
+	FrameContext frame;
+	frame.DeltaTime = 1.0f / 60.0f;
+
+	std::ostringstream detail;
+	detail << count << " moving entities";
+
+	for (unsigned threads : { 1u, 2u, 4u, 8u })
+	{
+		ThreadPool pool(threads);
+		std::ostringstream variant;
+		variant << threads << (threads == 1 ? "-thread" : "-threads");
+
+		report("parallel-update", variant.str(), measureMs(runs, [&]()
+		{
+			++frame.FrameIndex;
+			scene.step(frame, pool);
+		}), detail.str());
+	}
+}
+
+void benchDetach(const BenchOptions& options)
+{
+	const std::size_t count = options.size(20000, 400);
+	const int runs = options.runs(9);
+
+	// Every frame a quarter of a crowded layer is removed, and as many nodes
+	// are added back so the next frame starts from the same size.
+	TransformStore store;
+	store.reserve(count + 1);
+	NodePool<SceneNode> pool;
+	pool.reserve(count);
+	SceneNode layer(store);
+	layer.reserveChildren(count);
+
+	std::vector<SceneNode*> nodes;
+	std::vector<SceneNode*> victims;
+	for (std::size_t i = 0; i < count; ++i)
+	{
+		SceneNode::Ptr node = pool.create(store);
+		nodes.push_back(node.get());
+		if (i % 4 == 1)
+			victims.push_back(node.get());
+		layer.attachChild(std::move(node));
+	}
+
+	std::ostringstream detail;
+	detail << victims.size() << " of " << count << " children removed";
+
+	// How detachChild worked before: find the child, then erase it and shift
+	// every later sibling down.
+	{
+		std::vector<SceneNode::Ptr> children;
+		std::vector<SceneNode::Ptr> removed;
+		for (SceneNode* node : nodes)
+			children.push_back(layer.detachChild(*node));
+
+		report("detach", "find-and-erase", measureMs(runs, [&]()
+		{
+			for (SceneNode* victim : victims)
+			{
+				auto found = std::find_if(children.begin(), children.end(),
+					[victim](const SceneNode::Ptr& child) { return child.get() == victim; });
+				removed.push_back(std::move(*found));
+				children.erase(found);
+			}
+			for (SceneNode::Ptr& node : removed)
+				children.push_back(std::move(node));
+			removed.clear();
+		}), detail.str());
+
+		for (SceneNode::Ptr& node : children)
+			layer.attachChild(std::move(node));
+	}
+
+	std::vector<SceneNode::Ptr> removed;
+	removed.reserve(victims.size());
+
+	report("detach", "swap-and-pop", measureMs(runs, [&]()
+	{
+		for (SceneNode* victim : victims)
+			removed.push_back(layer.detachChild(*victim));
+		for (SceneNode::Ptr& node : removed)
+			layer.attachChild(std::move(node));
+		removed.clear();
+	}), detail.str());
+
+	report("detach", "batched", measureMs(runs, [&]()
+	{
+		SceneNode::detachChildren(victims, &removed);
+		for (SceneNode::Ptr& node : removed)
+			layer.attachChild(std::move(node));
+		removed.clear();
+	}), detail.str());
+}
@@ -0,0 +1,108 @@
+#include "Bench.h"
+#include "FrameContext.h"
+#include <cstdint>
+#include <memory>
+#include <sstream>
+#include <vector>
+
+namespace
+{
+	// GameTimer's fields, which every node used to receive a copy of.  The
+	// timer itself reads the Windows performance counter.
+	struct TimerCopy
+	{
+		double SecondsPerCount = 0.0;
+		double DeltaTime = 0.0;
+		std::int64_t BaseTime = 0;
+		std::int64_t PausedTime = 0;
+		std::int64_t StopTime = 0;
+		std::int64_t PrevTime = 0;
+		std::int64_t CurrTime = 0;
+		bool Stopped = false;
+	};
+
+	// The update path as it was and as it is: update calls updateCurrent,
+	// then updateChildren, which calls update on every child.  Only what is
+	// passed down differs.
+	template<typename Frame>
+	class PathNode
+	{
+	public:
+		typedef std::unique_ptr<PathNode> Ptr;
+
+		virtual ~PathNode() {}
+
+		void attachChild(Ptr child) { mChildren.push_back(std::move(child)); }
+
+		void update(Frame frame)
+		{
+			updateCurrent(frame);
+			updateChildren(frame);
+		}
+
+		double getValue() const { return mValue; }
+
+	private:
+		virtual void updateCurrent(Frame frame) { mValue += deltaTime(frame); }
+
+		void updateChildren(Frame frame)
+		{
+			for (Ptr& child : mChildren)
+				child->update(frame);
+		}
+
+		static double deltaTime(const TimerCopy& timer) { return timer.DeltaTime; }
+		static double deltaTime(const FrameContext& frame) { return frame.DeltaTime; }
+
+	private:
+		std::vector<Ptr> mChildren;
+		double mValue = 0.0;
+	};
+
+	// The same 4-ary tree as the cached-transform case.
+	template<typename Frame>
+	void buildTree(PathNode<Frame>& root, std::size_t count, std::vector<PathNode<Frame>*>& nodes)
+	{
+		nodes.clear();
+		nodes.reserve(count);
+		for (std::size_t i = 0; i < count; ++i)
+		{
+			typename PathNode<Frame>::Ptr node(new PathNode<Frame>());
+			PathNode<Frame>* raw = node.get();
+			PathNode<Frame>& parent = i == 0 ? root : *nodes[(i - 1) / 4];
+			parent.attachChild(std::move(node));
+			nodes.push_back(raw);
+		}
+	}
+}
+
+void benchFrameContext(const BenchOptions& options)
+{
+	const std::size_t count = options.size(100000, 2000);
+	const int runs = options.runs(15);
+
+	std::ostringstream detail;
+	detail << count << " nodes";
+
+	{
+		PathNode<TimerCopy> root;
+		std::vector<PathNode<TimerCopy>*> nodes;
+		buildTree(root, count, nodes);
+
+		TimerCopy timer;
+		timer.DeltaTime = 1.0 / 60.0;
+		report("frame-context", "timer-by-value", measureMs(runs, [&]() { root.update(timer); }), detail.str());
+		keep(nodes.back()->getValue());
+	}
+
+	{
+		PathNode<const FrameContext&> root;
+		std::vector<PathNode<const FrameContext&>*> nodes;
+		buildTree(root, count, nodes);
+
+		FrameContext frame;
+		frame.DeltaTime = 1.0f / 60.0f;
+		report("frame-context", "context-by-reference", measureMs(runs, [&]() { root.update(frame); }), detail.str());
+		keep(nodes.back()->getValue());
+	}
+}
@@ -0,0 +1,143 @@
+#include "Bench.h"
+#include "FrameConstants.h"
+#include "NullRenderDevice.h"
+#include "ObjectTransforms.h"
+#include <cstring>
+#include <sstream>
+#include <vector>
+
+namespace
+{
+	const std::size_t ObjectStride = NullRenderDevice::ObjectStride;
+
+	// Plain memory standing in for a mapped upload heap, cache line aligned
+	// the way NullRenderDevice aligns its object buffers.
+	struct UploadTarget
+	{
+		std::vector<std::uint8_t>	Storage;
+		std::uint8_t*				Data = nullptr;
+
+		explicit UploadTarget(std::size_t objectCount)
+		{
+			const std::size_t alignment = 64;
+
+			Storage.assign(objectCount * ObjectStride + alignment, 0);
+			std::uintptr_t address = (std::uintptr_t)Storage.data();
+			Data = Storage.data() + ((alignment - address % alignment) % alignment);
+		}
+	};
+
+	// Objects spread over a field, each with its own world matrix.
+	void addObjects(ObjectTransforms& objects, std::size_t count)
+	{
+		objects.reserve(count);
+		for (std::size_t i = 0; i < count; ++i)
+			objects.add(XMMatrixTranslation((float)(i % 100), 0.0f, (float)(i / 100)), XMMatrixIdentity());
+	}
+}
+
+void benchDirtyUpload(const BenchOptions& options)
+{
+	const std::size_t count = options.size(100000, 2000);
+	const int runs = options.runs(15);
+
+	// One frame resource, so every frame uploads what changed since the last.
+	ObjectTransforms objects(1);
+	addObjects(objects, count);
+	UploadTarget target(count);
+
+	std::ostringstream detail;
+	detail << count << " objects";
+
+	for (std::size_t percent : { 1, 10, 100 })
+	{
+		// Every frame the same evenly spread objects change.  Both variants
+		// pay for marking them; only finding them differs.
+		std::vector<ObjectTransforms::Handle> changed;
+		for (std::size_t i = 0; i < count; i += 100 / percent)
+			changed.push_back((ObjectTransforms::Handle)i);
+		const XMMATRIX texTransform = XMMatrixScaling(2.0f, 2.0f, 1.0f);
+
+		objects.clearDirty(0);
+
+		// How UpdateObjectCBs found them before: ask every object.
+		std::ostringstream scan;
+		scan << "full-scan-" << percent << "%-dirty";
+		report("dirty-upload", scan.str(), measureMs(runs, [&]()
+		{
+			for (ObjectTransforms::Handle handle : changed)
+				objects.setTexTransform(handle, texTransform);
+
+			for (ObjectTransforms::Handle handle = 0; handle < (ObjectTransforms::Handle)count; ++handle)
+			{
+				if (objects.isDirty(handle, 0))
+				{
+					ObjectTransforms::HandleRange one = { &handle, &handle + 1 };
+					objects.streamConstants(one, target.Data, ObjectStride);
+				}
+			}
+			objects.clearDirty(0);
+		}), detail.str());
+
+		std::ostringstream list;
+		list << "dirty-list-" << percent << "%-dirty";
+		report("dirty-upload", list.str(), measureMs(runs, [&]()
+		{
+			for (ObjectTransforms::Handle handle : changed)
+				objects.setTexTransform(handle, texTransform);
+
+			objects.streamConstants(objects.getDirty(0), target.Data, ObjectStride);
+			objects.clearDirty(0);
+		}), detail.str());
+	}
+}
+
+void benchStreamConstants(const BenchOptions& options)
+{
+	const std::size_t count = options.size(50000, 2000);
+	const int runs = options.runs(15);
+
+	// Every object animated, so every object is written every frame.
+	ObjectTransforms objects(1);
+	addObjects(objects, count);
+	UploadTarget target(count);
+
+	std::vector<ObjectTransforms::Handle> handles(count);
+	for (std::size_t i = 0; i < count; ++i)
+		handles[i] = (ObjectTransforms::Handle)i;
+	const ObjectTransforms::HandleRange all = { handles.data(), handles.data() + handles.size() };
+
+	// Bytes written per frame, in GB/s for a frame taking ms.
+	const double bytes = (double)count * ObjectStride;
+	auto rate = [bytes](double ms)
+	{
+		std::ostringstream detail;
+		detail.precision(3);
+		detail << bytes / (ms * 1.0e6) << " GB/s";
+		return detail.str();
+	};
+
+	// How UpdateObjectCBs wrote them before: build the constants on the
+	// stack, transpose them, then copy them in.
+	double ms = measureMs(runs, [&]()
+	{
+		for (ObjectTransforms::Handle handle : handles)
+		{
+			XMMATRIX world = XMLoadFloat4x4(&objects.getWorld(handle));
+			XMMATRIX texTransform = XMLoadFloat4x4(&objects.getTexTransform(handle));
+
+			ObjectConstants objConstants;
+			XMStoreFloat4x4(&objConstants.World, XMMatrixTranspose(world));
+			XMStoreFloat4x4(&objConstants.TexTransform, XMMatrixTranspose(texTransform));
+
+			std::memcpy(target.Data + handle * ObjectStride, &objConstants, sizeof(ObjectConstants));
+		}
+	});
+	report("stream-constants", "copy-per-object", ms, rate(ms));
+
+	ms = measureMs(runs, [&]()
+	{
+		objects.streamConstants(all, target.Data, ObjectStride);
+	});
+	report("stream-constants", "streamed", ms, rate(ms));
+}
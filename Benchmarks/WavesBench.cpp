@@ -0,0 +1,174 @@
+#include "Bench.h"
+#include "ThreadPool.h"
+#include "Waves.h"
+#include <iterator>
+#include <memory>
+#include <sstream>
+#include <vector>
+
+using namespace DirectX;
+
+namespace
+{
+	// The constants of the book's land-and-waves demo.
+	const float SpatialStep = 1.0f;
+	const float TimeStep = 0.03f;
+	const float Speed = 4.0f;
+	const float Damping = 0.2f;
+
+	std::unique_ptr<Waves> makeWaves(int size)
+	{
+		return std::unique_ptr<Waves>(new Waves(size, size, SpatialStep, TimeStep, Speed, Damping));
+	}
+
+	// Disturbs points spread over the whole grid, so no tile sleeps and
+	// every step solves every interior point.
+	void disturbEverywhere(Waves& waves)
+	{
+		for (int i = 4; i < waves.RowCount() - 4; i += 16)
+			for (int j = 4; j < waves.ColumnCount() - 4; j += 16)
+				waves.Disturb(i, j, 0.5f);
+	}
+
+	// The solver as it was before the height fields: whole positions in both
+	// time levels, of which only y ever changes.
+	class PositionGrid
+	{
+	public:
+		explicit PositionGrid(int size)
+			: mSize(size)
+			, mPrev(size * size, XMFLOAT3(0.0f, 0.0f, 0.0f))
+			, mCurr(size * size, XMFLOAT3(0.0f, 0.0f, 0.0f))
+		{
+			float d = Damping*TimeStep + 2.0f;
+			float e = (Speed*Speed)*(TimeStep*TimeStep) / (SpatialStep*SpatialStep);
+			mK1 = (Damping*TimeStep - 2.0f) / d;
+			mK2 = (4.0f - 8.0f*e) / d;
+			mK3 = (2.0f*e) / d;
+
+			for (int i = 4; i < size - 4; i += 16)
+				for (int j = 4; j < size - 4; j += 16)
+					mCurr[i*size + j].y = 0.5f;
+		}
+
+		void Step()
+		{
+			const int n = mSize;
+			for (int i = 1; i < n-1; ++i)
+			{
+				for (int j = 1; j < n-1; ++j)
+				{
+					mPrev[i*n+j].y = mK1*mPrev[i*n+j].y + mK2*mCurr[i*n+j].y +
+						mK3*(mCurr[(i+1)*n+j].y + mCurr[(i-1)*n+j].y + mCurr[i*n+j+1].y + mCurr[i*n+j-1].y);
+				}
+			}
+			mPrev.swap(mCurr);
+		}
+
+		float Height(int i) const { return mCurr[i].y; }
+
+	private:
+		int mSize;
+		float mK1, mK2, mK3;
+		std::vector<XMFLOAT3> mPrev;
+		std::vector<XMFLOAT3> mCurr;
+	};
+
+	// The rate a step of ms streams through the grid at, reading both time
+	// levels and writing one, pointBytes per point and level.
+	std::string stepRate(int size, std::size_t pointBytes, double ms)
+	{
+		std::ostringstream rate;
+		rate.precision(3);
+		rate << size << 'x' << size << ' ' << 3.0 * size * size * pointBytes / (ms * 1.0e6) << " GB/s";
+		return rate.str();
+	}
+
+	std::string gridName(int size)
+	{
+		std::ostringstream name;
+		name << size << 'x' << size;
+		return name.str();
+	}
+}
+
+void benchWavesThreads(const BenchOptions& options)
+{
+	const int quickSizes[] = { 64 };
+	const int fullSizes[] = { 256, 1024, 4096 };
+
+	const int* first = options.Quick ? std::begin(quickSizes) : std::begin(fullSizes);
+	const int* last = options.Quick ? std::end(quickSizes) : std::end(fullSizes);
+
+	for (const int* size = first; size != last; ++size)
+	{
+		std::unique_ptr<Waves> waves = makeWaves(*size);
+		disturbEverywhere(*waves);
+
+		const int runs = options.runs(*size > 1024 ? 5 : 15);
+
+		// One step per Update, on the calling thread and then on pools.
+		report("waves-threads", "no-pool", measureMs(runs, [&]() { waves->Update(TimeStep); }), gridName(*size));
+
+		for (unsigned threads : { 1u, 2u, 4u })
+		{
+			ThreadPool pool(threads);
+			waves->SetThreadPool(&pool);
+
+			std::ostringstream variant;
+			variant << threads << (threads == 1 ? "-thread" : "-threads");
+			report("waves-threads", variant.str(), measureMs(runs, [&]() { waves->Update(TimeStep); }), gridName(*size));
+
+			waves->SetThreadPool(nullptr);
+		}
+	}
+}
+
+void benchWavesStencil(const BenchOptions& options)
+{
+	const int quickSizes[] = { 64 };
+	const int fullSizes[] = { 512, 1024, 2048 };
+
+	const int* first = options.Quick ? std::begin(quickSizes) : std::begin(fullSizes);
+	const int* last = options.Quick ? std::end(quickSizes) : std::end(fullSizes);
+
+	for (const int* size = first; size != last; ++size)
+	{
+		const int runs = options.runs(*size > 1024 ? 7 : 15);
+
+		PositionGrid positions(*size);
+		double ms = measureMs(runs, [&]() { positions.Step(); });
+		keep(positions.Height(*size * (*size / 2) + *size / 2));
+		report("waves-stencil", "xmfloat3-grid", ms, stepRate(*size, sizeof(XMFLOAT3), ms));
+
+		// The stencil alone: Update(dt) steps without writing vertices.
+		std::unique_ptr<Waves> waves = makeWaves(*size);
+		disturbEverywhere(*waves);
+		ms = measureMs(runs, [&]() { waves->Update(TimeStep); });
+		report("waves-stencil", "height-field", ms, stepRate(*size, sizeof(float), ms));
+	}
+}
+
+void benchWavesSleep(const BenchOptions& options)
+{
+	const int size = (int)options.size(2048, 256);
+	const int runs = options.runs(15);
+
+	// A calm sea with one disturbed spot, and the same sea disturbed all
+	// over.  Tiles at rest sleep, so the first costs what the spot and the
+	// tiles its ripples have reached cost.
+	for (bool calm : { true, false })
+	{
+		std::unique_ptr<Waves> waves = makeWaves(size);
+		if (calm)
+			waves->Disturb(size / 2, size / 2, 0.5f);
+		else
+			disturbEverywhere(*waves);
+
+		double ms = measureMs(runs, [&]() { waves->Update(TimeStep); });
+
+		std::ostringstream detail;
+		detail << gridName(size) << ' ' << waves->ActiveTileCount() << " of " << waves->TileCount() << " tiles active";
+		report("waves-sleep", calm ? "one-spot" : "disturbed-everywhere", ms, detail.str());
+	}
+}
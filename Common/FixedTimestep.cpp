@@ -0,0 +1,56 @@
+#include "FixedTimestep.h"
+#include <cassert>
+
+FixedTimestep::FixedTimestep(float step, int maxStepsPerFrame, double catchUpBudget)
+	: mStep(step)
+	, mMaxStepsPerFrame(maxStepsPerFrame)
+	, mCatchUpBudget(catchUpBudget)
+	, mAccumulator(0.0)
+{
+	assert(step >= 0.0f && maxStepsPerFrame > 0 && catchUpBudget >= 0.0);
+}
+
+int FixedTimestep::advance(double elapsed)
+{
+	if (mStep <= 0.0f)
+		return 0;
+
+	mAccumulator += elapsed;
+
+	int steps = 0;
+	while (mAccumulator >= mStep && steps < mMaxStepsPerFrame)
+	{
+		mAccumulator -= mStep;
+		++steps;
+	}
+
+	if (mAccumulator >= mStep)
+		mAccumulator = mAccumulator < mCatchUpBudget ? mAccumulator : mCatchUpBudget;
+
+	return steps;
+}
+
+void FixedTimestep::reset()
+{
+	mAccumulator = 0.0;
+}
+
+float FixedTimestep::step()const
+{
+	return mStep;
+}
+
+int FixedTimestep::maxStepsPerFrame()const
+{
+	return mMaxStepsPerFrame;
+}
+
+float FixedTimestep::alpha()const
+{
+	if (mStep <= 0.0f)
+		return 1.0f;
+
+	// Time carried over for catching up can make up more than a step.
+	double alpha = mAccumulator / mStep;
+	return alpha < 1.0 ? (float)alpha : 1.0f;
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+// Turns variable frame times into a whole number of fixed simulation steps.
+// Time that does not yet make up a whole step is carried over to the next
+// frame, so the simulation sees the same sequence of steps whatever the frame
+// rate is.
+class FixedTimestep
+{
+public:
+	// A step of 0 turns fixed stepping off.  See advance for catchUpBudget.
+	explicit FixedTimestep(float step = 0.0f, int maxStepsPerFrame = 8, double catchUpBudget = 0.0);
+
+	// Adds elapsed seconds and returns how many steps are now due.  Beyond
+	// maxStepsPerFrame up to catchUpBudget seconds of surplus are carried over
+	// and worked off in later frames, still at most maxStepsPerFrame at a
+	// time.  The rest is dropped, so a long stall slows the simulation down
+	// instead of making every following frame slower still.
+	int advance(double elapsed);
+
+	// Forgets any time carried over.
+	void reset();
+
+	float step()const;
+	int maxStepsPerFrame()const;
+
+	// How far real time is past the last due step, as a fraction of a step.
+	float alpha()const;
+
+private:
+	float mStep;
+	int mMaxStepsPerFrame;
+	double mCatchUpBudget;
+	double mAccumulator;
+};
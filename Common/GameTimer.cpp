@@ -125,8 +125,9 @@ void GameTimer::Tick()
 	}
 }
 
-
-
-
-
-
+void GameTimer::Advance(double seconds)
+{
+	mCurrTime += (__int64)(seconds / mSecondsPerCount);
+	mPrevTime = mCurrTime;
+	mDeltaTime = seconds;
+}
@@ -18,6 +18,10 @@ public:
 	void Stop();  // Call when paused.
 	void Tick();  // Call every frame.
 
+	// Moves the clock on by exactly seconds instead of reading the
+	// performance counter, so replays see the same times on every run.
+	void Advance(double seconds);
+
 private:
 	double mSecondsPerCount;
 	double mDeltaTime;
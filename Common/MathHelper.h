@@ -6,9 +6,13 @@
 
 #pragma once
 
+#ifdef _WIN32
 #include <Windows.h>
+#endif
 #include <DirectXMath.h>
+#include <cmath>
 #include <cstdint>
+#include <cstdlib>
 
 class MathHelper
 {
@@ -50,6 +50,18 @@ public:
         return mUploadBuffer.Get();
     }
 
+    // For writers that fill many elements at once instead of using CopyData.
+    // The memory is write-combined: write it sequentially and never read it.
+    BYTE* MappedData()const
+    {
+        return mMappedData;
+    }
+
+    UINT ElementByteSize()const
+    {
+        return mElementByteSize;
+    }
+
     void CopyData(int elementIndex, const T& data)
     {
         memcpy(&mMappedData[elementIndex*mElementByteSize], &data, sizeof(T));
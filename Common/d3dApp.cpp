@@ -37,6 +37,16 @@ D3DApp::~D3DApp()
 		FlushCommandQueue();
 }
 
+void D3DApp::SetFixedTimeStep(float seconds, int maxStepsPerFrame)
+{
+	mStepClock = FixedTimestep(seconds, maxStepsPerFrame);
+}
+
+float D3DApp::StepAlpha()const
+{
+	return mStepClock.alpha();
+}
+
 HINSTANCE D3DApp::AppInst()const
 {
 	return mhAppInst;
@@ -91,8 +101,7 @@ int D3DApp::Run()
 			if( !mAppPaused )
 			{
 				CalculateFrameStats();
-				Update(mTimer);	
-                Draw(mTimer);
+				StepAndDraw();
 			}
 			else
 			{
@@ -104,6 +113,29 @@ int D3DApp::Run()
 	return (int)msg.wParam;
 }
 
+void D3DApp::RunFrame(double seconds)
+{
+	mTimer.Advance(seconds);
+	StepAndDraw();
+}
+
+void D3DApp::StepAndDraw()
+{
+	if(mStepClock.step() > 0.0f)
+	{
+		int steps = mStepClock.advance(mTimer.DeltaTime());
+		for(int i = 0; i < steps; ++i)
+			Step(mStepClock.step());
+	}
+	else
+	{
+		Step(mTimer.DeltaTime());
+	}
+
+	Update(mTimer);
+	Draw(mTimer);
+}
+
 bool D3DApp::Initialize()
 {
 	if(!InitMainWindow())
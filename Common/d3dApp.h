@@ -9,6 +9,7 @@
 
 #include "d3dUtil.h"
 #include "GameTimer.h"
+#include "FixedTimestep.h"
 
 // Link necessary d3d12 libraries.
 #pragma comment(lib,"d3dcompiler.lib")
@@ -36,6 +37,15 @@ public:
     void Set4xMsaaState(bool value);
 
 	int Run();
+
+	// With a non-zero step, Run calls Step with exactly that dt as often as
+	// the elapsed time allows before each Update and Draw.  Otherwise Step is
+	// called once per frame with the frame's dt.
+	void SetFixedTimeStep(float seconds, int maxStepsPerFrame = 8);
+
+	// Runs one frame as if exactly seconds had passed since the last, without
+	// reading the clock or pumping messages.  For headless replays.
+	void RunFrame(double seconds);
  
     virtual bool Initialize();
     virtual LRESULT MsgProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam);
@@ -46,6 +56,13 @@ protected:
 	virtual void Update(const GameTimer& gt)=0;
     virtual void Draw(const GameTimer& gt)=0;
 
+	// Advances the simulation by dt seconds.
+	virtual void Step(float dt){ }
+
+	// How far the frame being drawn is past the last Step, as a fraction of a
+	// fixed step; 1 without one.
+	float StepAlpha()const;
+
 	// Convenience overrides for handling mouse input.
 	virtual void OnMouseDown(WPARAM btnState, int x, int y){ }
 	virtual void OnMouseUp(WPARAM btnState, int x, int y)  { }
@@ -53,6 +70,10 @@ protected:
 
 protected:
 
+	// Steps the simulation for the time the timer last advanced by, then
+	// updates and draws.
+	void StepAndDraw();
+
 	bool InitMainWindow();
 	bool InitDirect3D();
 	void CreateCommandObjects();
@@ -88,6 +109,7 @@ protected:
 
 	// Used to keep track of the delta-time and game time (4.4).
 	GameTimer mTimer;
+	FixedTimestep mStepClock;
 	
     Microsoft::WRL::ComPtr<IDXGIFactory4> mdxgiFactory;
     Microsoft::WRL::ComPtr<IDXGISwapChain> mSwapChain;
@@ -1,8 +1,9 @@
 #include "Aircraft.h"
 
 
-Aircraft::Aircraft(Type type)
-	: mType(type)
+Aircraft::Aircraft(Type type, TransformStore& transforms)
+	: Entity(transforms)
+	, mType(type)
 {
 	
 }
@@ -11,7 +12,3 @@ void Aircraft::Update()
 {
 	
 }
-
-void Aircraft::drawCurrent(GameTimer dt) 
-{
-}
\ No newline at end of file
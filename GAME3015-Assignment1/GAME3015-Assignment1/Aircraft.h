@@ -13,15 +13,11 @@ public:
 
 
 public:
-	Aircraft(Type type);
+	Aircraft(Type type, TransformStore& transforms);
 
 	void Update();
 
 
-private:
-	virtual void		drawCurrent(GameTimer dt) ;
-
-
 private:
 	Type				mType;
 
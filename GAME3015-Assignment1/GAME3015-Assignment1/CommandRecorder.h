@@ -0,0 +1,20 @@
+#pragma once
+
+#include "DrawCommandList.h"
+
+// Hands out the command lists a DrawQueue records into, one per chunk.
+// beginList and endList are called on the recording thread; different
+// indices may be recorded at the same time, a single index never is.
+class CommandRecorder
+{
+public:
+	virtual					~CommandRecorder() {}
+
+	// Number of lists that can be recorded in one frame.
+	virtual unsigned		listCount() const = 0;
+
+	// Prepares list index for recording, with the state every chunk shares
+	// (render targets, root signature, pass constants) already bound.
+	virtual DrawCommandList&	beginList(unsigned index) = 0;
+	virtual void			endList(unsigned index) = 0;
+};
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "ResourceRegistry.h"
+#include <cstdint>
+
+// Primitive topologies, numbered as D3D_PRIMITIVE_TOPOLOGY so the D3D12
+// backend can pass them straight through.
+enum class PrimitiveTopology : std::uint32_t
+{
+	PointList = 1,
+	LineList = 2,
+	LineStrip = 3,
+	TriangleList = 4,
+	TriangleStrip = 5,
+};
+
+// The state changes and draws a DrawQueue emits.  World implements this on top
+// of an ID3D12GraphicsCommandList; RecordingCommandList implements it without
+// a GPU so the emitted stream can be inspected.
+class DrawCommandList
+{
+public:
+	virtual					~DrawCommandList() {}
+
+	virtual void			setPipelineState(PsoHandle pso) = 0;
+	virtual void			setMaterial(MaterialHandle material) = 0;
+	virtual void			setMesh(MeshHandle mesh) = 0;
+	virtual void			setPrimitiveTopology(std::uint32_t topology) = 0;
+
+	// firstInstance is the offset of the draw's first entry in the frame's
+	// instance list; the instances themselves are numbered from 0.
+	virtual void			drawIndexedInstanced(std::uint32_t indexCount, std::uint32_t instanceCount,
+								std::uint32_t startIndexLocation, std::int32_t baseVertexLocation,
+								std::uint32_t firstInstance) = 0;
+};
@@ -0,0 +1,296 @@
+#include "DrawQueue.h"
+#include <cassert>
+
+
+namespace
+{
+	const int PassBits = 4;
+	const int PsoBits = 8;
+	const int MaterialBits = 12;
+	const int MeshBits = 12;
+	const int DepthBits = 28;
+
+	std::uint64_t field(std::uint32_t value, int bits)
+	{
+		assert(value < (1u << bits));
+		return (std::uint64_t)(value & ((1u << bits) - 1));
+	}
+}
+
+std::uint32_t DrawQueue::Stats::skipped() const
+{
+	return PsoBindsSkipped + MaterialBindsSkipped + MeshBindsSkipped + TopologyBindsSkipped;
+}
+
+DrawQueue::Stats& DrawQueue::Stats::operator+=(const Stats& rhs)
+{
+	Lists += rhs.Lists;
+	Draws += rhs.Draws;
+	Instances += rhs.Instances;
+	PsoBinds += rhs.PsoBinds;
+	MaterialBinds += rhs.MaterialBinds;
+	MeshBinds += rhs.MeshBinds;
+	TopologyBinds += rhs.TopologyBinds;
+	PsoBindsSkipped += rhs.PsoBindsSkipped;
+	MaterialBindsSkipped += rhs.MaterialBindsSkipped;
+	MeshBindsSkipped += rhs.MeshBindsSkipped;
+	TopologyBindsSkipped += rhs.TopologyBindsSkipped;
+	return *this;
+}
+
+std::uint64_t DrawQueue::makeKey(const Packet& packet)
+{
+	float depth = packet.Depth < 0.0f ? 0.0f : (packet.Depth > 1.0f ? 1.0f : packet.Depth);
+	std::uint32_t maxDepth = (1u << DepthBits) - 1;
+	std::uint32_t quantized = (std::uint32_t)(depth * (float)maxDepth);
+	if (quantized > maxDepth)
+		quantized = maxDepth;
+
+	std::uint64_t state = field(packet.Pso.Index, PsoBits);
+	state = (state << MaterialBits) | field(packet.Material.Index, MaterialBits);
+	state = (state << MeshBits) | field(packet.Mesh.Index, MeshBits);
+
+	std::uint64_t key = field(packet.Pass, PassBits);
+	if (packet.BackToFront)
+	{
+		key = (key << DepthBits) | (maxDepth - quantized);
+		key = (key << (PsoBits + MaterialBits + MeshBits)) | state;
+	}
+	else
+	{
+		key = (key << (PsoBits + MaterialBits + MeshBits)) | state;
+		key = (key << DepthBits) | quantized;
+	}
+	return key;
+}
+
+void DrawQueue::clear()
+{
+	mPackets.clear();
+	mKeys.clear();
+	mOrder.clear();
+	mInstanceObjects.clear();
+}
+
+void DrawQueue::reserve(std::size_t count)
+{
+	mPackets.reserve(count);
+	mKeys.reserve(count);
+	mOrder.reserve(count);
+	mScratch.reserve(count);
+	mInstanceObjects.reserve(count);
+}
+
+void DrawQueue::add(const Packet& packet)
+{
+	mOrder.push_back((std::uint32_t)mPackets.size());
+	mPackets.push_back(packet);
+	mKeys.push_back(makeKey(packet));
+}
+
+std::size_t DrawQueue::size() const
+{
+	return mPackets.size();
+}
+
+void DrawQueue::sort()
+{
+	sortKeys();
+
+	mInstanceObjects.resize(mOrder.size());
+	for (std::size_t i = 0; i < mOrder.size(); ++i)
+		mInstanceObjects[i] = mPackets[mOrder[i]].ObjCBIndex;
+}
+
+void DrawQueue::sortKeys()
+{
+	const std::size_t count = mPackets.size();
+	if (count < 2)
+		return;
+
+	// One histogram per key byte, all filled in a single read of the keys.
+	std::uint32_t histograms[8][256] = {};
+	for (std::size_t i = 0; i < count; ++i)
+	{
+		std::uint64_t key = mKeys[i];
+		for (int b = 0; b < 8; ++b)
+			++histograms[b][(key >> (b * 8)) & 0xff];
+	}
+
+	// Least significant byte first; each pass is a stable counting sort.
+	mScratch.resize(count);
+	for (int b = 0; b < 8; ++b)
+	{
+		std::uint32_t* histogram = histograms[b];
+
+		// Every key has the same byte here, so this pass would not move anything.
+		if (histogram[(mKeys[0] >> (b * 8)) & 0xff] == count)
+			continue;
+
+		std::uint32_t offset = 0;
+		for (int i = 0; i < 256; ++i)
+		{
+			std::uint32_t n = histogram[i];
+			histogram[i] = offset;
+			offset += n;
+		}
+
+		for (std::size_t i = 0; i < count; ++i)
+		{
+			std::uint32_t packet = mOrder[i];
+			mScratch[histogram[(mKeys[packet] >> (b * 8)) & 0xff]++] = packet;
+		}
+		mOrder.swap(mScratch);
+	}
+}
+
+const std::vector<std::uint32_t>& DrawQueue::getInstanceObjects() const
+{
+	return mInstanceObjects;
+}
+
+void DrawQueue::split(std::size_t maxPackets, std::size_t maxChunks, std::vector<Chunk>& chunks) const
+{
+	assert(maxPackets > 0 && maxChunks > 0);
+
+	chunks.clear();
+	for (std::size_t first = 0; first < mOrder.size(); )
+	{
+		const std::uint32_t pass = mPackets[mOrder[first]].Pass;
+
+		std::size_t last = first;
+		while (last < mOrder.size() && last - first < maxPackets && mPackets[mOrder[last]].Pass == pass)
+			last = runEnd(last);
+
+		Chunk chunk;
+		chunk.First = (std::uint32_t)first;
+		chunk.Count = (std::uint32_t)(last - first);
+		chunks.push_back(chunk);
+
+		first = last;
+	}
+
+	while (chunks.size() > maxChunks)
+	{
+		std::size_t smallest = 0;
+		for (std::size_t i = 1; i + 1 < chunks.size(); ++i)
+		{
+			if (chunks[i].Count + chunks[i + 1].Count < chunks[smallest].Count + chunks[smallest + 1].Count)
+				smallest = i;
+		}
+
+		chunks[smallest].Count += chunks[smallest + 1].Count;
+		chunks.erase(chunks.begin() + smallest + 1);
+	}
+}
+
+DrawQueue::Stats DrawQueue::submit(DrawCommandList& commandList) const
+{
+	Chunk all;
+	all.Count = (std::uint32_t)mOrder.size();
+	return submit(commandList, all);
+}
+
+DrawQueue::Stats DrawQueue::submit(DrawCommandList& commandList, const Chunk& chunk) const
+{
+	assert(mInstanceObjects.size() == mOrder.size());
+
+	Stats stats;
+	stats.Lists = 1;
+
+	const std::size_t end = chunk.First + chunk.Count;
+	const Packet* previous = nullptr;
+	for (std::size_t first = chunk.First; first < end; )
+	{
+		const Packet& packet = mPackets[mOrder[first]];
+		std::size_t last = runEnd(first);
+
+		if (!previous || previous->Pso != packet.Pso)
+		{
+			commandList.setPipelineState(packet.Pso);
+			++stats.PsoBinds;
+		}
+		else
+			++stats.PsoBindsSkipped;
+
+		if (!previous || previous->Mesh != packet.Mesh)
+		{
+			commandList.setMesh(packet.Mesh);
+			++stats.MeshBinds;
+		}
+		else
+			++stats.MeshBindsSkipped;
+
+		if (!previous || previous->Topology != packet.Topology)
+		{
+			commandList.setPrimitiveTopology(packet.Topology);
+			++stats.TopologyBinds;
+		}
+		else
+			++stats.TopologyBindsSkipped;
+
+		if (!previous || previous->Material != packet.Material)
+		{
+			commandList.setMaterial(packet.Material);
+			++stats.MaterialBinds;
+		}
+		else
+			++stats.MaterialBindsSkipped;
+
+		std::uint32_t instanceCount = (std::uint32_t)(last - first);
+		commandList.drawIndexedInstanced(packet.IndexCount, instanceCount,
+			packet.StartIndexLocation, packet.BaseVertexLocation, (std::uint32_t)first);
+		++stats.Draws;
+		stats.Instances += instanceCount;
+
+		previous = &packet;
+		first = last;
+	}
+
+	return stats;
+}
+
+DrawQueue::Stats DrawQueue::record(CommandRecorder& recorder, ThreadPool& pool, std::size_t maxPacketsPerChunk) const
+{
+	std::vector<Chunk> chunks;
+	split(maxPacketsPerChunk, recorder.listCount(), chunks);
+
+	std::vector<Stats> results(chunks.size());
+	for (std::size_t i = 0; i < chunks.size(); ++i)
+	{
+		pool.submit([this, &recorder, &chunks, &results, i]()
+		{
+			DrawCommandList& commandList = recorder.beginList((unsigned)i);
+			results[i] = submit(commandList, chunks[i]);
+			recorder.endList((unsigned)i);
+		});
+	}
+	pool.wait();
+
+	Stats stats;
+	for (const Stats& result : results)
+		stats += result;
+	return stats;
+}
+
+std::size_t DrawQueue::runEnd(std::size_t first) const
+{
+	const Packet& packet = mPackets[mOrder[first]];
+
+	std::size_t last = first + 1;
+	while (last < mOrder.size() && canShareDraw(packet, mPackets[mOrder[last]]))
+		++last;
+	return last;
+}
+
+bool DrawQueue::canShareDraw(const Packet& a, const Packet& b)
+{
+	return a.Pass == b.Pass
+		&& a.Pso == b.Pso
+		&& a.Material == b.Material
+		&& a.Mesh == b.Mesh
+		&& a.Topology == b.Topology
+		&& a.IndexCount == b.IndexCount
+		&& a.StartIndexLocation == b.StartIndexLocation
+		&& a.BaseVertexLocation == b.BaseVertexLocation;
+}
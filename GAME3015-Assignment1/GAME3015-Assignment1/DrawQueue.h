@@ -0,0 +1,125 @@
+#pragma once
+
+#include "CommandRecorder.h"
+#include "DrawCommandList.h"
+#include "ResourceRegistry.h"
+#include "ThreadPool.h"
+#include <cstdint>
+#include <vector>
+
+// Collects one packet per object, sorts the packets by a 64-bit key and emits
+// them with only the state changes that differ from the previous packet.
+// Neighbouring packets that share every piece of state and the same draw
+// arguments are merged into one instanced draw.
+//
+// Key layout, most significant bits first:
+//   front to back:  pass (4) | pso (8) | material (12) | mesh (12) | depth (28)
+//   back to front:  pass (4) | inverted depth (28) | pso (8) | material (12) | mesh (12)
+// Opaque passes sort by state and use depth only to break ties; blended passes
+// must be drawn far to near, so depth wins over state there.
+//
+// The sorted packets can be split into chunks and recorded into several
+// command lists at once; each chunk starts from no bound state.
+class DrawQueue
+{
+public:
+	struct Packet
+	{
+		std::uint32_t		Pass = 0;
+		bool				BackToFront = false;
+
+		PsoHandle			Pso;
+		MaterialHandle		Material;
+		MeshHandle			Mesh;
+		std::uint32_t		Topology = 0;
+
+		// Normalized view depth in [0, 1]; values outside are clamped.
+		float				Depth = 0.0f;
+
+		std::uint32_t		ObjCBIndex = 0;
+		std::uint32_t		IndexCount = 0;
+		std::uint32_t		StartIndexLocation = 0;
+		std::int32_t		BaseVertexLocation = 0;
+	};
+
+	// A range of sorted packets recorded into one command list.
+	struct Chunk
+	{
+		std::uint32_t		First = 0;
+		std::uint32_t		Count = 0;
+	};
+
+	// Binds issued and binds skipped because the previous packet in the same
+	// command list already set the same state.
+	struct Stats
+	{
+		std::uint32_t		Lists = 0;
+		std::uint32_t		Draws = 0;
+		std::uint32_t		Instances = 0;
+
+		std::uint32_t		PsoBinds = 0;
+		std::uint32_t		MaterialBinds = 0;
+		std::uint32_t		MeshBinds = 0;
+		std::uint32_t		TopologyBinds = 0;
+
+		std::uint32_t		PsoBindsSkipped = 0;
+		std::uint32_t		MaterialBindsSkipped = 0;
+		std::uint32_t		MeshBindsSkipped = 0;
+		std::uint32_t		TopologyBindsSkipped = 0;
+
+		std::uint32_t		skipped() const;
+		Stats&				operator+=(const Stats& rhs);
+	};
+
+
+public:
+	static std::uint64_t	makeKey(const Packet& packet);
+
+	void					clear();
+	void					reserve(std::size_t count);
+	void					add(const Packet& packet);
+	std::size_t				size() const;
+
+	// Orders the packets by key.  Packets with equal keys keep the order they
+	// were added in.  Must be called before anything is submitted.
+	void					sort();
+
+	// ObjCBIndex of every packet in sorted order; the packet at sorted position
+	// k is instance k.  Draws address this list through their firstInstance.
+	const std::vector<std::uint32_t>&	getInstanceObjects() const;
+
+	// Splits the sorted packets at pass boundaries and splits large passes into
+	// chunks of roughly maxPackets.  An instanced run is never cut in two.  If
+	// that gives more than maxChunks chunks, the smallest neighbours are merged.
+	void					split(std::size_t maxPackets, std::size_t maxChunks, std::vector<Chunk>& chunks) const;
+
+	// Emits the whole queue, or one chunk of it, into a single command list.
+	// No state is assumed to be bound on the command list beforehand.
+	Stats					submit(DrawCommandList& commandList) const;
+	Stats					submit(DrawCommandList& commandList, const Chunk& chunk) const;
+
+	// Splits the queue into at most recorder.listCount() chunks and records each
+	// into its own command list on the pool's threads.  Chunk i goes to list i,
+	// so the lists execute in draw order.
+	Stats					record(CommandRecorder& recorder, ThreadPool& pool, std::size_t maxPacketsPerChunk) const;
+
+
+private:
+	static bool				canShareDraw(const Packet& a, const Packet& b);
+
+	void					sortKeys();
+
+	// One past the last packet of the instanced run starting at sorted position first.
+	std::size_t				runEnd(std::size_t first) const;
+
+
+private:
+	std::vector<Packet>			mPackets;
+	std::vector<std::uint64_t>	mKeys;
+
+	// Packet indices in sorted order, plus scratch space for the radix passes.
+	std::vector<std::uint32_t>	mOrder;
+	std::vector<std::uint32_t>	mScratch;
+
+	std::vector<std::uint32_t>	mInstanceObjects;
+};
@@ -1,26 +1,29 @@
 #include "Entity.h"
 
+Entity::Entity(TransformStore& transforms)
+	: SceneNode(transforms)
+{
+}
+
 void Entity::setVelocity(XMVECTOR velocity)
 {
-	mVelocity = velocity;
+	mTransforms->setVelocity(mTransform, velocity);
 }
 
 void Entity::setVelocity(float vx, float vy, float vz)
 {
-	mVelocity = XMVECTOR{ vx, vy, vz };
+	mTransforms->setVelocity(mTransform, XMVectorSet(vx, vy, vz, 0.0f));
 }
 
 XMVECTOR Entity::getVelocity() const
 {
-	return mVelocity;
+	return mTransforms->getVelocity(mTransform);
 }
 
-void Entity::updateCurrent(GameTimer dt, std::vector<std::unique_ptr<RenderItem>>& renderList)
+void Entity::updateCurrent(const FrameContext& frame, ObjectTransforms& objects)
 {
-	XMVECTOR displacement = mVelocity * dt.DeltaTime();
-	mPosition = XMVectorAdd(SceneNode::getWorldPosition(), displacement);
-	renderItem = std::move(renderList[renderIndex]);
-	renderItem->NumFramesDirty = 1;
-	XMStoreFloat4x4(&renderItem->World, XMMatrixScaling(XMVectorGetX(Scale), XMVectorGetY(Scale), XMVectorGetZ(Scale)) * XMMatrixTranslationFromVector(mPosition));
-	renderList[renderIndex] = std::move(renderItem);
+	// Integration and world matrix composition already happened in the
+	// TransformStore sweeps; only a changed result needs to reach the render item.
+	if (renderHandle != ObjectTransforms::InvalidHandle && mTransforms->worldChanged(mTransform))
+		objects.setWorld(renderHandle, getWorldTransform());
 }
\ No newline at end of file
@@ -7,13 +7,12 @@ class Entity : public SceneNode
 {
 
 public:
+	explicit Entity(TransformStore& transforms);
+
 	void setVelocity(XMVECTOR velocity);
 	void setVelocity(float vx, float vy, float vz);
 	XMVECTOR getVelocity() const;
 
-	virtual	void		updateCurrent(GameTimer dt, std::vector<std::unique_ptr<RenderItem>>& renderList);
-public:
-	XMVECTOR mVelocity;
+	virtual	void		updateCurrent(const FrameContext& frame, ObjectTransforms& objects);
 
 };
-
@@ -0,0 +1,40 @@
+#include "FrameArena.h"
+#include <cassert>
+
+
+FrameArena::FrameArena(std::size_t capacity)
+	: mMemory(new std::uint8_t[capacity])
+	, mCapacity(capacity)
+	, mOffset(0)
+{
+}
+
+void* FrameArena::allocate(std::size_t size, std::size_t alignment)
+{
+	assert((alignment & (alignment - 1)) == 0);
+
+	// Reserve enough for the worst-case padding, then align inside the block.
+	std::size_t offset = mOffset.fetch_add(size + alignment - 1);
+	if (offset + size + alignment - 1 > mCapacity)
+		return nullptr;
+
+	std::uintptr_t address = reinterpret_cast<std::uintptr_t>(mMemory.get()) + offset;
+	address = (address + alignment - 1) & ~(std::uintptr_t)(alignment - 1);
+	return reinterpret_cast<void*>(address);
+}
+
+void FrameArena::reset()
+{
+	mOffset.store(0);
+}
+
+std::size_t FrameArena::capacity() const
+{
+	return mCapacity;
+}
+
+std::size_t FrameArena::used() const
+{
+	std::size_t offset = mOffset.load();
+	return offset < mCapacity ? offset : mCapacity;
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+// Linear scratch allocator whose contents only live for one frame.  Allocation
+// is a single atomic bump so update jobs on any thread may use it; nothing is
+// freed individually, the whole arena is reset at the start of the next frame.
+class FrameArena
+{
+public:
+	explicit FrameArena(std::size_t capacity);
+	FrameArena(const FrameArena& rhs) = delete;
+	FrameArena& operator=(const FrameArena& rhs) = delete;
+
+	// Returns nullptr once the arena is exhausted.
+	void*					allocate(std::size_t size, std::size_t alignment = alignof(std::max_align_t));
+
+	template<typename T>
+	T*						allocateArray(std::size_t count)
+	{
+		return static_cast<T*>(allocate(sizeof(T) * count, alignof(T)));
+	}
+
+	// Only call between frames, once nothing still refers to the old contents.
+	void					reset();
+
+	std::size_t				capacity() const;
+	std::size_t				used() const;
+
+
+private:
+	std::unique_ptr<std::uint8_t[]>	mMemory;
+	std::size_t						mCapacity;
+	std::atomic<std::size_t>		mOffset;
+};
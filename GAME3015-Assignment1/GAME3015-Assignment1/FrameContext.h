@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstdint>
+
+class FrameArena;
+class SceneCommandQueue;
+
+// Immutable per-frame state handed down the whole update path by const
+// reference, instead of copying the GameTimer into every node.
+struct FrameContext
+{
+	// Seconds elapsed since the previous frame.
+	float DeltaTime = 0.0f;
+
+	// Seconds elapsed since the timer was reset, not counting paused time.
+	float TotalTime = 0.0f;
+
+	// Number of frames updated before this one.
+	std::uint64_t FrameIndex = 0;
+
+	// Scratch memory that stays valid until the next frame begins.
+	FrameArena* Arena = nullptr;
+
+	// Where nodes queue spawns, destroys and reparents during the update.
+	SceneCommandQueue* Commands = nullptr;
+};
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <cstdint>
+
+// The GPU timeline a FrameScheduler paces against.  Values increase by one
+// per submitted frame; a value is complete once the GPU has finished all the
+// work submitted before it was signalled.
+class FrameFence
+{
+public:
+	virtual					~FrameFence() {}
+
+	// Highest value the GPU has finished.
+	virtual std::uint64_t	completedValue() const = 0;
+
+	// Blocks until value is complete.  Every frame resource has its own wait
+	// object, picked by slot, which is kept for the lifetime of the fence.
+	virtual void			wait(int slot, std::uint64_t value) = 0;
+
+	// Queues the next value behind the work submitted so far and returns it.
+	virtual std::uint64_t	signal() = 0;
+};
@@ -7,9 +7,14 @@ FrameResource::FrameResource(ID3D12Device* device, UINT passCount, UINT objectCo
 		IID_PPV_ARGS(CmdListAlloc.GetAddressOf())));
 
   //  FrameCB = std::make_unique<UploadBuffer<FrameConstants>>(device, 1, true);
-    PassCB = std::make_unique<UploadBuffer<PassConstants>>(device, passCount, true);
     MaterialCB = std::make_unique<UploadBuffer<MaterialConstants>>(device, materialCount, true);
-    ObjectCB = std::make_unique<UploadBuffer<ObjectConstants>>(device, objectCount, true);
+    ObjectData = std::make_unique<UploadBuffer<ObjectConstants>>(device, objectCount, false);
+    ObjectCapacity = objectCount;
+
+    // Start with room for the pass constants and an instance list covering every object.
+    UINT passBytes = passCount * d3dUtil::CalcConstantBufferByteSize(sizeof(PassConstants));
+    UINT instanceBytes = d3dUtil::CalcConstantBufferByteSize(objectCount * sizeof(UINT));
+    FrameData = std::make_unique<UploadAllocator>(device, passBytes + instanceBytes);
 
     WavesVB = std::make_unique<UploadBuffer<Vertex>>(device, waveVertCount, false);
 }
@@ -21,13 +26,52 @@ FrameResource::FrameResource(ID3D12Device* device, UINT passCount, UINT objectCo
 		IID_PPV_ARGS(CmdListAlloc.GetAddressOf())));
 
 	//  FrameCB = std::make_unique<UploadBuffer<FrameConstants>>(device, 1, true);
-	PassCB = std::make_unique<UploadBuffer<PassConstants>>(device, passCount, true);
 	MaterialCB = std::make_unique<UploadBuffer<MaterialConstants>>(device, materialCount, true);
-	ObjectCB = std::make_unique<UploadBuffer<ObjectConstants>>(device, objectCount, true);
+	ObjectData = std::make_unique<UploadBuffer<ObjectConstants>>(device, objectCount, false);
+	ObjectCapacity = objectCount;
+
+	// Start with room for the pass constants and an instance list covering every object.
+	UINT passBytes = passCount * d3dUtil::CalcConstantBufferByteSize(sizeof(PassConstants));
+	UINT instanceBytes = d3dUtil::CalcConstantBufferByteSize(objectCount * sizeof(UINT));
+	FrameData = std::make_unique<UploadAllocator>(device, passBytes + instanceBytes);
 
 }
 
 FrameResource::~FrameResource()
 {
 
+}
+
+bool FrameResource::ReserveObjects(ID3D12Device* device, UINT count)
+{
+	if (count <= ObjectCapacity)
+		return false;
+
+	// Grow geometrically so a steady trickle of spawns does not recreate the buffer every frame.
+	UINT capacity = ObjectCapacity * 2;
+	if (capacity < count)
+		capacity = count;
+
+	ObjectData = std::make_unique<UploadBuffer<ObjectConstants>>(device, capacity, false);
+	ObjectCapacity = capacity;
+	return true;
+}
+
+void FrameResource::CreateWorkerCommandLists(ID3D12Device* device, UINT count)
+{
+	WorkerCmdListAllocs.resize(count);
+	WorkerCmdLists.resize(count);
+
+	for (UINT i = 0; i < count; ++i)
+	{
+		ThrowIfFailed(device->CreateCommandAllocator(
+			D3D12_COMMAND_LIST_TYPE_DIRECT,
+			IID_PPV_ARGS(WorkerCmdListAllocs[i].GetAddressOf())));
+
+		ThrowIfFailed(device->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_DIRECT,
+			WorkerCmdListAllocs[i].Get(), nullptr, IID_PPV_ARGS(WorkerCmdLists[i].GetAddressOf())));
+
+		// Command lists are created in the recording state; the first beginList resets it.
+		ThrowIfFailed(WorkerCmdLists[i]->Close());
+	}
 }
\ No newline at end of file
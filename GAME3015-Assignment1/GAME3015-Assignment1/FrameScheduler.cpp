@@ -0,0 +1,61 @@
+#include "FrameScheduler.h"
+#include <cassert>
+
+
+FrameScheduler::FrameScheduler()
+	: mFence(nullptr)
+	, mCurrent(0)
+{
+}
+
+void FrameScheduler::reset(FrameFence& fence, int framesInFlight)
+{
+	assert(framesInFlight > 0);
+
+	mFence = &fence;
+	mFenceValues.assign(framesInFlight, 0);
+	mCurrent = 0;
+	mStats = Stats();
+}
+
+int FrameScheduler::framesInFlight() const
+{
+	return (int)mFenceValues.size();
+}
+
+int FrameScheduler::currentFrame() const
+{
+	return mCurrent;
+}
+
+int FrameScheduler::beginFrame()
+{
+	// Cycle through the circular frame resource array.
+	mCurrent = (mCurrent + 1) % (int)mFenceValues.size();
+	return mCurrent;
+}
+
+bool FrameScheduler::isReady() const
+{
+	return mFence->completedValue() >= mFenceValues[mCurrent];
+}
+
+void FrameScheduler::waitReady()
+{
+	if (isReady())
+		return;
+
+	++mStats.Stalls;
+	mFence->wait(mCurrent, mFenceValues[mCurrent]);
+}
+
+void FrameScheduler::endFrame()
+{
+	mFenceValues[mCurrent] = mFence->signal();
+	++mStats.Frames;
+}
+
+const FrameScheduler::Stats& FrameScheduler::getStats() const
+{
+	return mStats;
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "FrameFence.h"
+#include <cstdint>
+#include <vector>
+
+// Paces the CPU against the GPU over a ring of frame resources.  Starting a
+// frame only picks the next frame resource; the wait for the GPU to release
+// it is a separate step, so simulation and other work that does not touch
+// frame resource memory can run while the GPU is still busy with it.
+class FrameScheduler
+{
+public:
+	struct Stats
+	{
+		std::uint64_t		Frames = 0;
+
+		// Frames whose frame resource was still in use when waitReady was called.
+		std::uint64_t		Stalls = 0;
+	};
+
+
+public:
+	FrameScheduler();
+	FrameScheduler(const FrameScheduler& rhs) = delete;
+	FrameScheduler& operator=(const FrameScheduler& rhs) = delete;
+
+	// Starts pacing against fence over framesInFlight frame resources.
+	void					reset(FrameFence& fence, int framesInFlight);
+
+	int						framesInFlight() const;
+	int						currentFrame() const;
+
+	// Moves on to the next frame resource without waiting and returns it.
+	int						beginFrame();
+
+	// Whether the GPU is done with the current frame resource.
+	bool					isReady() const;
+
+	// Blocks until it is.  Call before writing to the frame resource.
+	void					waitReady();
+
+	// Call once the frame is submitted; the frame resource stays in use until
+	// the GPU gets through it.
+	void					endFrame();
+
+	const Stats&			getStats() const;
+
+
+private:
+	FrameFence*					mFence;
+
+	// Fence value each frame resource was last submitted with; 0 if never.
+	std::vector<std::uint64_t>	mFenceValues;
+	int							mCurrent;
+	Stats						mStats;
+};
@@ -0,0 +1,65 @@
+#include "../../Common/FixedTimestep.h"
+#include "NullRenderDevice.h"
+#include "Scene.h"
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+
+// Runs the scene on a NullRenderDevice, with no window and no GPU, for a
+// fixed number of frames of fixed length:
+//
+//     Headless [FRAMES [SECONDS_PER_FRAME]]
+//
+// Writes the same "frame,cpu_ms,hash" lines as a replay, then what the
+// device was asked to draw and upload.  Builds on any platform DirectXMath
+// does.
+int main(int argc, char** argv)
+{
+	int frames = argc > 1 ? std::atoi(argv[1]) : 600;
+	double frameTime = argc > 2 ? std::atof(argv[2]) : 1.0 / 60.0;
+	if (frames <= 0 || frameTime <= 0.0)
+	{
+		std::cerr << "usage: " << argv[0] << " [FRAMES [SECONDS_PER_FRAME]]\n";
+		return 1;
+	}
+
+	Scene scene;
+	NullRenderDevice device(scene.GetThreadPool().threadCount());
+	scene.Build(device);
+
+	// Stepped the way World steps it.
+	FixedTimestep stepClock(1.0f / 60.0f);
+	double totalTime = 0.0;
+
+	std::cout << "frame,cpu_ms,hash\n" << std::setfill('0');
+
+	for (int frame = 0; frame < frames; ++frame)
+	{
+		auto start = std::chrono::steady_clock::now();
+
+		totalTime += frameTime;
+		int steps = stepClock.advance(frameTime);
+		for (int i = 0; i < steps; ++i)
+			scene.Step(stepClock.step());
+
+		scene.Update((float)totalTime, (float)frameTime, stepClock.alpha());
+		scene.Draw();
+
+		auto end = std::chrono::steady_clock::now();
+		double ms = std::chrono::duration<double, std::milli>(end - start).count();
+
+		std::cout << frame << ',' << std::fixed << std::setprecision(4) << ms << ','
+			<< std::hex << std::setw(16) << scene.HashRenderItems() << std::dec << '\n';
+	}
+
+	const NullRenderDevice::Stats& stats = device.getStats();
+	std::cout << "# frames " << stats.Frames << ", draws " << stats.Draws
+		<< ", commands " << stats.CommandsSubmitted << '\n';
+	std::cout << "# upload bytes pass " << stats.UploadBytes[(int)FrameBuffer::PassConstants]
+		<< " material " << stats.UploadBytes[(int)FrameBuffer::MaterialConstants]
+		<< " object " << stats.UploadBytes[(int)FrameBuffer::ObjectData]
+		<< " instance " << stats.UploadBytes[(int)FrameBuffer::InstanceIndices] << '\n';
+
+	return 0;
+}
@@ -0,0 +1,107 @@
+#include "InputScript.h"
+#include <algorithm>
+#include <cctype>
+#include <sstream>
+#include <string>
+
+
+namespace
+{
+	bool parseType(const std::string& name, InputScript::Event::Type& type)
+	{
+		static const struct
+		{
+			const char*				name;
+			InputScript::Event::Type	type;
+		} types[] =
+		{
+			{ "keydown", InputScript::Event::KeyDown },
+			{ "keyup", InputScript::Event::KeyUp },
+			{ "mousedown", InputScript::Event::MouseDown },
+			{ "mouseup", InputScript::Event::MouseUp },
+			{ "mousemove", InputScript::Event::MouseMove },
+		};
+
+		for (const auto& entry : types)
+		{
+			if (name == entry.name)
+			{
+				type = entry.type;
+				return true;
+			}
+		}
+		return false;
+	}
+}
+
+bool InputScript::load(std::istream& in)
+{
+	mEvents.clear();
+	mErrorLine = 0;
+
+	std::string line;
+	for (int lineNumber = 1; std::getline(in, line); ++lineNumber)
+	{
+		std::istringstream fields(line);
+
+		std::string first;
+		if (!(fields >> first) || first[0] == '#')
+			continue;
+
+		Event event;
+		std::string type;
+		std::istringstream frame(first);
+		bool valid = (frame >> event.Frame) && frame.eof() && (fields >> type) && parseType(type, event.Kind);
+
+		if (valid && (event.Kind == Event::KeyDown || event.Kind == Event::KeyUp))
+		{
+			std::string key;
+			valid = (fields >> key) && key.size() == 1;
+			if (valid)
+				event.Key = std::toupper((unsigned char)key[0]);
+		}
+		else if (valid)
+		{
+			valid = (bool)(fields >> event.X >> event.Y);
+		}
+
+		std::string trailing;
+		if (!valid || (fields >> trailing && trailing[0] != '#'))
+		{
+			mEvents.clear();
+			mErrorLine = lineNumber;
+			return false;
+		}
+
+		mEvents.push_back(event);
+	}
+
+	// Events of the same frame keep the order they were written in.
+	std::stable_sort(mEvents.begin(), mEvents.end(),
+		[](const Event& a, const Event& b) { return a.Frame < b.Frame; });
+
+	return true;
+}
+
+int InputScript::errorLine() const
+{
+	return mErrorLine;
+}
+
+InputScript::EventRange InputScript::eventsAt(std::uint32_t frame) const
+{
+	auto first = std::lower_bound(mEvents.begin(), mEvents.end(), frame,
+		[](const Event& event, std::uint32_t frame) { return event.Frame < frame; });
+	auto last = std::upper_bound(first, mEvents.end(), frame,
+		[](std::uint32_t frame, const Event& event) { return frame < event.Frame; });
+
+	EventRange events;
+	events.First = mEvents.data() + (first - mEvents.begin());
+	events.Last = mEvents.data() + (last - mEvents.begin());
+	return events;
+}
+
+bool InputScript::empty() const
+{
+	return mEvents.empty();
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstdint>
+#include <istream>
+#include <vector>
+
+// Keyboard and mouse input recorded against frame numbers, so a replay sees
+// exactly the same input on every run.  One event per line:
+//
+//     # frame  event      arguments
+//     0        keydown    W
+//     90       keyup      W
+//     100      mousedown  400 300
+//     101      mousemove  410 300
+//     130      mouseup    410 300
+//
+// Blank lines and lines starting with # are ignored.  Keys are given as the
+// character of their virtual key, as GetAsyncKeyState takes them.
+class InputScript
+{
+public:
+	struct Event
+	{
+		enum Type
+		{
+			KeyDown,
+			KeyUp,
+			MouseDown,
+			MouseUp,
+			MouseMove,
+		};
+
+		std::uint32_t	Frame = 0;
+		Type			Kind = KeyDown;
+		int				Key = 0;
+		int				X = 0;
+		int				Y = 0;
+	};
+
+	struct EventRange
+	{
+		const Event*		First;
+		const Event*		Last;
+
+		const Event*		begin() const { return First; }
+		const Event*		end() const { return Last; }
+	};
+
+
+public:
+	InputScript() = default;
+
+	// Replaces the script with the one read from in.  On a malformed line
+	// the script is left empty, false is returned and errorLine says which.
+	bool					load(std::istream& in);
+	int						errorLine() const;
+
+	// Every event of the given frame, in the order they were written.
+	EventRange				eventsAt(std::uint32_t frame) const;
+
+	bool					empty() const;
+
+
+private:
+	// Sorted by frame.
+	std::vector<Event>		mEvents;
+	int						mErrorLine = 0;
+};
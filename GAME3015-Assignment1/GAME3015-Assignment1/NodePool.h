@@ -0,0 +1,130 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+class SceneNode;
+
+// Lets a node be handed back to the pool it came from without knowing its
+// concrete type.
+class NodePoolBase
+{
+public:
+	virtual ~NodePoolBase() = default;
+	virtual void			release(SceneNode* node) = 0;
+};
+
+// Deleter used by SceneNode::Ptr: pooled nodes go back to their pool, nodes
+// created with plain new are deleted.
+struct SceneNodeDeleter
+{
+	void operator()(SceneNode* node) const;
+};
+
+// Typed slab allocator for scene nodes.  Objects are constructed in place in
+// fixed-size slabs of contiguous memory, and released slots are recycled through
+// an intrusive free list, so steady-state spawning and despawning never reaches
+// the global heap.  The pool must outlive every node it hands out.
+template<typename T>
+class NodePool : public NodePoolBase
+{
+public:
+	typedef std::unique_ptr<T, SceneNodeDeleter> Ptr;
+
+
+public:
+	explicit NodePool(std::size_t slabSize = 256)
+		: mSlabSize(slabSize)
+		, mFreeList(nullptr)
+		, mLiveCount(0)
+	{
+		assert(slabSize > 0);
+	}
+
+	NodePool(const NodePool& rhs) = delete;
+	NodePool& operator=(const NodePool& rhs) = delete;
+
+	~NodePool()
+	{
+		assert(mLiveCount == 0);
+	}
+
+	// Makes sure count more objects can be created without allocating a slab.
+	void reserve(std::size_t count)
+	{
+		std::size_t available = 0;
+		for (Slot* slot = mFreeList; slot != nullptr; slot = slot->next)
+			++available;
+
+		while (available < count)
+		{
+			addSlab();
+			available += mSlabSize;
+		}
+	}
+
+	template<typename... Args>
+	Ptr create(Args&&... args)
+	{
+		if (mFreeList == nullptr)
+			addSlab();
+
+		Slot* slot = mFreeList;
+		mFreeList = slot->next;
+
+		T* object = new (slot->storage) T(std::forward<Args>(args)...);
+		object->mPool = this;
+		++mLiveCount;
+		return Ptr(object);
+	}
+
+	virtual void release(SceneNode* node) override
+	{
+		T* object = static_cast<T*>(node);
+		object->~T();
+
+		Slot* slot = reinterpret_cast<Slot*>(object);
+		slot->next = mFreeList;
+		mFreeList = slot;
+		--mLiveCount;
+	}
+
+	std::size_t liveCount() const
+	{
+		return mLiveCount;
+	}
+
+
+private:
+	union Slot
+	{
+		Slot* next;
+		alignas(T) unsigned char storage[sizeof(T)];
+	};
+
+
+private:
+	void addSlab()
+	{
+		std::unique_ptr<Slot[]> slab(new Slot[mSlabSize]);
+
+		// Thread the new slots onto the free list in address order.
+		for (std::size_t i = 0; i + 1 < mSlabSize; ++i)
+			slab[i].next = &slab[i + 1];
+		slab[mSlabSize - 1].next = mFreeList;
+		mFreeList = &slab[0];
+
+		mSlabs.push_back(std::move(slab));
+	}
+
+
+private:
+	std::vector<std::unique_ptr<Slot[]>>	mSlabs;
+	std::size_t							mSlabSize;
+	Slot*								mFreeList;
+	std::size_t							mLiveCount;
+};
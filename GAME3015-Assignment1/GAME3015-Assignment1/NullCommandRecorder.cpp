@@ -0,0 +1,46 @@
+#include "NullCommandRecorder.h"
+
+
+NullCommandRecorder::NullCommandRecorder(unsigned listCount)
+	: mLists(listCount)
+	, mUsed(listCount, 0)
+{
+}
+
+unsigned NullCommandRecorder::listCount() const
+{
+	return (unsigned)mLists.size();
+}
+
+DrawCommandList& NullCommandRecorder::beginList(unsigned index)
+{
+	mLists[index].clear();
+	return mLists[index];
+}
+
+void NullCommandRecorder::endList(unsigned index)
+{
+	mUsed[index] = 1;
+}
+
+unsigned NullCommandRecorder::usedCount() const
+{
+	unsigned count = 0;
+	for (std::uint8_t used : mUsed)
+		count += used;
+	return count;
+}
+
+const RecordingCommandList& NullCommandRecorder::getList(unsigned index) const
+{
+	return mLists[index];
+}
+
+void NullCommandRecorder::clear()
+{
+	for (std::size_t i = 0; i < mLists.size(); ++i)
+	{
+		mLists[i].clear();
+		mUsed[i] = 0;
+	}
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include "CommandRecorder.h"
+#include "RecordingCommandList.h"
+#include <cstdint>
+#include <vector>
+
+// CommandRecorder over RecordingCommandLists, for running the recording path
+// without a GPU.
+class NullCommandRecorder : public CommandRecorder
+{
+public:
+	explicit				NullCommandRecorder(unsigned listCount);
+
+	virtual unsigned		listCount() const override;
+	virtual DrawCommandList&	beginList(unsigned index) override;
+	virtual void			endList(unsigned index) override;
+
+	// Lists begun since the last clear, and what was recorded into each.
+	unsigned				usedCount() const;
+	const RecordingCommandList&	getList(unsigned index) const;
+	void					clear();
+
+
+private:
+	std::vector<RecordingCommandList>	mLists;
+	// One byte each, so lists ended on different threads never share a word.
+	std::vector<std::uint8_t>			mUsed;
+};
@@ -0,0 +1,133 @@
+#include "NullRenderDevice.h"
+#include <cassert>
+
+
+NullRenderDevice::NullRenderDevice(unsigned listCount)
+	: mRecorder(listCount)
+	, mFence(1)
+	, mFrameResourceCount(0)
+	, mFrameResource(0)
+{
+}
+
+void NullRenderDevice::createMeshBuffers(MeshHandle mesh, const void* vertices, std::uint32_t vertexBytes,
+	std::uint32_t vertexStride, const void* indices, std::uint32_t indexBytes)
+{
+	mStats.MeshBytes += vertexBytes + indexBytes;
+}
+
+void NullRenderDevice::createFrameResources(int count, std::uint32_t objectCount, std::uint32_t materialCount)
+{
+	mFrameResourceCount = count;
+	mObjectBuffers.resize(count);
+	for (ObjectBuffer& buffer : mObjectBuffers)
+		allocateObjects(buffer, objectCount);
+}
+
+FrameFence& NullRenderDevice::fence()
+{
+	return mFence;
+}
+
+void NullRenderDevice::beginFrame(int frameResource)
+{
+	assert(frameResource >= 0 && frameResource < mFrameResourceCount);
+	mFrameResource = frameResource;
+	mRecorder.clear();
+}
+
+bool NullRenderDevice::reserveObjects(std::uint32_t count)
+{
+	ObjectBuffer& buffer = mObjectBuffers[mFrameResource];
+	if (count <= buffer.Capacity)
+		return false;
+
+	allocateObjects(buffer, buffer.Capacity * 2 > count ? buffer.Capacity * 2 : count);
+	++mStats.ObjectBufferGrowths;
+	return true;
+}
+
+void NullRenderDevice::upload(FrameBuffer buffer, std::uint32_t element, const void* data, std::size_t size)
+{
+	++mStats.Uploads[(int)buffer];
+	mStats.UploadBytes[(int)buffer] += size;
+}
+
+void NullRenderDevice::uploadObjects(const ObjectTransforms& objects, ObjectTransforms::HandleRange handles, float alpha)
+{
+	const ObjectBuffer& buffer = mObjectBuffers[mFrameResource];
+	assert(objects.size() <= buffer.Capacity);
+
+	objects.streamConstants(handles, buffer.Data, ObjectStride, alpha);
+
+	mStats.Uploads[(int)FrameBuffer::ObjectData] += handles.size();
+	mStats.UploadBytes[(int)FrameBuffer::ObjectData] += handles.size() * ObjectStride;
+}
+
+void NullRenderDevice::uploadFrameData(FrameBuffer buffer, const void* data, std::size_t size)
+{
+	++mStats.Uploads[(int)buffer];
+	mStats.UploadBytes[(int)buffer] += size;
+}
+
+void NullRenderDevice::clear(const float color[4])
+{
+	++mStats.Clears;
+}
+
+CommandRecorder& NullRenderDevice::recorder()
+{
+	return mRecorder;
+}
+
+void NullRenderDevice::endFrame(unsigned listCount)
+{
+	assert(listCount <= mRecorder.usedCount());
+
+	for (unsigned i = 0; i < listCount; ++i)
+	{
+		const RecordingCommandList& list = mRecorder.getList(i);
+		mStats.CommandsSubmitted += list.getCommands().size();
+		mStats.Draws += list.count(RecordingCommandList::Command::DrawIndexedInstanced);
+	}
+
+	mStats.ListsSubmitted += listCount;
+	++mStats.Frames;
+}
+
+const NullRenderDevice::Stats& NullRenderDevice::getStats() const
+{
+	return mStats;
+}
+
+const NullCommandRecorder& NullRenderDevice::getRecorder() const
+{
+	return mRecorder;
+}
+
+int NullRenderDevice::getFrameResource() const
+{
+	return mFrameResource;
+}
+
+SimulatedFence& NullRenderDevice::getFence()
+{
+	return mFence;
+}
+
+const void* NullRenderDevice::getObjectData() const
+{
+	return mObjectBuffers[mFrameResource].Data;
+}
+
+void NullRenderDevice::allocateObjects(ObjectBuffer& buffer, std::uint32_t capacity)
+{
+	// Upload heaps are at least 64KB aligned; cache line alignment is all the
+	// streaming stores care about.
+	const std::size_t alignment = 64;
+
+	buffer.Storage.assign(capacity * ObjectStride + alignment, 0);
+	std::uintptr_t address = (std::uintptr_t)buffer.Storage.data();
+	buffer.Data = buffer.Storage.data() + ((alignment - address % alignment) % alignment);
+	buffer.Capacity = capacity;
+}
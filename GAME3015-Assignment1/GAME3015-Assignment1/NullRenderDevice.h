@@ -0,0 +1,85 @@
+#pragma once
+
+#include "NullCommandRecorder.h"
+#include "RenderDevice.h"
+#include "SimulatedFence.h"
+#include <cstdint>
+#include <vector>
+
+// RenderDevice without a GPU.  Object data is streamed into plain memory that
+// stands in for the mapped upload heap, other uploads are only counted, and
+// draws are recorded into memory, so the CPU cost of building a frame can be
+// measured and checked on machines without D3D12.
+class NullRenderDevice : public RenderDevice
+{
+public:
+	struct Stats
+	{
+		std::uint64_t		Frames = 0;
+		std::uint64_t		Clears = 0;
+		std::uint64_t		ListsSubmitted = 0;
+		std::uint64_t		CommandsSubmitted = 0;
+		std::uint64_t		Draws = 0;
+
+		std::uint64_t		Uploads[(int)FrameBuffer::Count] = {};
+		std::uint64_t		UploadBytes[(int)FrameBuffer::Count] = {};
+
+		std::uint64_t		MeshBytes = 0;
+		std::uint64_t		ObjectBufferGrowths = 0;
+	};
+
+
+public:
+	explicit				NullRenderDevice(unsigned listCount);
+
+	virtual void			createMeshBuffers(MeshHandle mesh, const void* vertices, std::uint32_t vertexBytes,
+								std::uint32_t vertexStride, const void* indices, std::uint32_t indexBytes) override;
+	virtual void			createFrameResources(int count, std::uint32_t objectCount, std::uint32_t materialCount) override;
+
+	virtual FrameFence&		fence() override;
+	virtual void			beginFrame(int frameResource) override;
+	virtual bool			reserveObjects(std::uint32_t count) override;
+	virtual void			upload(FrameBuffer buffer, std::uint32_t element, const void* data, std::size_t size) override;
+	virtual void			uploadObjects(const ObjectTransforms& objects, ObjectTransforms::HandleRange handles, float alpha) override;
+	virtual void			uploadFrameData(FrameBuffer buffer, const void* data, std::size_t size) override;
+	virtual void			clear(const float color[4]) override;
+	virtual CommandRecorder&	recorder() override;
+	virtual void			endFrame(unsigned listCount) override;
+
+	const Stats&			getStats() const;
+	const NullCommandRecorder&	getRecorder() const;
+	int						getFrameResource() const;
+
+	// Defaults to a GPU that runs one frame behind.
+	SimulatedFence&			getFence();
+
+	// The current frame resource's object data, ObjectStride bytes per object.
+	const void*				getObjectData() const;
+
+	static const std::size_t	ObjectStride = 2 * sizeof(XMFLOAT4X4);
+
+
+private:
+	// Object data of one frame resource, grown the same way the D3D12 backend
+	// grows its object buffers.
+	struct ObjectBuffer
+	{
+		std::vector<std::uint8_t>	Storage;
+		std::uint8_t*				Data = nullptr;
+		std::uint32_t				Capacity = 0;
+	};
+
+
+private:
+	void					allocateObjects(ObjectBuffer& buffer, std::uint32_t capacity);
+
+
+private:
+	NullCommandRecorder		mRecorder;
+	SimulatedFence			mFence;
+	Stats					mStats;
+	int						mFrameResourceCount;
+	int						mFrameResource;
+
+	std::vector<ObjectBuffer>	mObjectBuffers;
+};
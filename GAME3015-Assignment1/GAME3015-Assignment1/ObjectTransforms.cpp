@@ -0,0 +1,295 @@
+#include "ObjectTransforms.h"
+#include <cassert>
+
+
+namespace
+{
+	// Writes the transpose of m to 16 floats at out, bypassing the cache.
+	void streamTransposed(const XMFLOAT4X4& m, float* out)
+	{
+#if defined(_XM_SSE_INTRINSICS_)
+		__m128 r0 = _mm_loadu_ps(m.m[0]);
+		__m128 r1 = _mm_loadu_ps(m.m[1]);
+		__m128 r2 = _mm_loadu_ps(m.m[2]);
+		__m128 r3 = _mm_loadu_ps(m.m[3]);
+		_MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+
+		_mm_stream_ps(out, r0);
+		_mm_stream_ps(out + 4, r1);
+		_mm_stream_ps(out + 8, r2);
+		_mm_stream_ps(out + 12, r3);
+#else
+		for (int row = 0; row < 4; ++row)
+			for (int col = 0; col < 4; ++col)
+				out[row * 4 + col] = m.m[col][row];
+#endif
+	}
+
+	// As streamTransposed, for prev + (curr - prev) * alpha.
+	void streamTransposedLerp(const XMFLOAT4X4& prev, const XMFLOAT4X4& curr, float alpha, float* out)
+	{
+#if defined(_XM_SSE_INTRINSICS_)
+		__m128 a = _mm_set1_ps(alpha);
+		__m128 r[4];
+		for (int row = 0; row < 4; ++row)
+		{
+			__m128 p = _mm_loadu_ps(prev.m[row]);
+			__m128 c = _mm_loadu_ps(curr.m[row]);
+			r[row] = _mm_add_ps(p, _mm_mul_ps(_mm_sub_ps(c, p), a));
+		}
+		_MM_TRANSPOSE4_PS(r[0], r[1], r[2], r[3]);
+
+		_mm_stream_ps(out, r[0]);
+		_mm_stream_ps(out + 4, r[1]);
+		_mm_stream_ps(out + 8, r[2]);
+		_mm_stream_ps(out + 12, r[3]);
+#else
+		for (int row = 0; row < 4; ++row)
+			for (int col = 0; col < 4; ++col)
+				out[row * 4 + col] = prev.m[col][row] + (curr.m[col][row] - prev.m[col][row]) * alpha;
+#endif
+	}
+}
+
+ObjectTransforms::ObjectTransforms(int frameResourceCount)
+	: mAllFrames(0)
+{
+	mMoving.Count = 0;
+	setFrameResourceCount(frameResourceCount);
+}
+
+void ObjectTransforms::setFrameResourceCount(int frameResourceCount)
+{
+	// The top bit of every object's dirty bits is MovingBit.
+	assert(frameResourceCount > 0 && frameResourceCount < 31);
+	assert(mWorld.empty());
+
+	mAllFrames = (1u << frameResourceCount) - 1u;
+
+	mDirtyLists.clear();
+	for (int i = 0; i < frameResourceCount; ++i)
+	{
+		mDirtyLists.push_back(std::make_unique<DirtyList>());
+		mDirtyLists.back()->Count = 0;
+	}
+}
+
+ObjectTransforms::Handle ObjectTransforms::add(FXMMATRIX world, CXMMATRIX texTransform)
+{
+	Handle handle;
+	if (!mFreeHandles.empty())
+	{
+		handle = mFreeHandles.back();
+		mFreeHandles.pop_back();
+	}
+	else
+	{
+		handle = (Handle)mWorld.size();
+		mWorld.emplace_back();
+		mPrevWorld.emplace_back();
+		mTexTransform.emplace_back();
+		mDirtyFrames.push_back(0);
+
+		for (auto& list : mDirtyLists)
+			list->Handles.resize(mWorld.size());
+		mMoving.Handles.resize(mWorld.size());
+	}
+
+	// New objects start at rest, so there is nothing to interpolate from.
+	XMStoreFloat4x4(&mWorld[handle], world);
+	mPrevWorld[handle] = mWorld[handle];
+	XMStoreFloat4x4(&mTexTransform[handle], texTransform);
+	markDirty(handle, mAllFrames);
+
+	return handle;
+}
+
+void ObjectTransforms::remove(Handle handle)
+{
+	mFreeHandles.push_back(handle);
+}
+
+void ObjectTransforms::reserve(std::size_t count)
+{
+	mWorld.reserve(count);
+	mPrevWorld.reserve(count);
+	mTexTransform.reserve(count);
+	mDirtyFrames.reserve(count);
+
+	for (auto& list : mDirtyLists)
+		list->Handles.reserve(count);
+	mMoving.Handles.reserve(count);
+}
+
+std::size_t ObjectTransforms::size() const
+{
+	return mWorld.size();
+}
+
+void ObjectTransforms::setWorld(Handle handle, FXMMATRIX world)
+{
+	XMStoreFloat4x4(&mWorld[handle], world);
+	markDirty(handle, mAllFrames);
+	markMoving(handle);
+}
+
+void ObjectTransforms::setTexTransform(Handle handle, FXMMATRIX texTransform)
+{
+	XMStoreFloat4x4(&mTexTransform[handle], texTransform);
+	markDirty(handle, mAllFrames);
+}
+
+const XMFLOAT4X4& ObjectTransforms::getWorld(Handle handle) const
+{
+	return mWorld[handle];
+}
+
+const XMFLOAT4X4& ObjectTransforms::getPreviousWorld(Handle handle) const
+{
+	return mPrevWorld[handle];
+}
+
+const XMFLOAT4X4& ObjectTransforms::getTexTransform(Handle handle) const
+{
+	return mTexTransform[handle];
+}
+
+void ObjectTransforms::beginStep()
+{
+	// Settling changes what an interpolated frame shows, so every frame
+	// resource needs the object again.
+	const std::uint32_t count = mMoving.Count.load();
+	for (std::uint32_t i = 0; i < count; ++i)
+	{
+		Handle handle = mMoving.Handles[i];
+		mPrevWorld[handle] = mWorld[handle];
+		mDirtyFrames[handle] &= ~MovingBit;
+		markDirty(handle, mAllFrames);
+	}
+
+	mMoving.Count = 0;
+}
+
+ObjectTransforms::HandleRange ObjectTransforms::getMoving() const
+{
+	HandleRange range;
+	range.First = mMoving.Handles.data();
+	range.Last = range.First + mMoving.Count.load();
+	return range;
+}
+
+void ObjectTransforms::markMovingDirty(int frameResource)
+{
+	for (Handle handle : getMoving())
+		markDirty(handle, 1u << frameResource);
+}
+
+void ObjectTransforms::streamConstants(HandleRange handles, void* dest, std::size_t stride, float alpha) const
+{
+	assert(((std::uintptr_t)dest & 15) == 0 && (stride & 15) == 0);
+	assert(stride >= 2 * sizeof(XMFLOAT4X4));
+
+	// Every element covers whole 16-byte blocks and, with a 128-byte stride,
+	// whole cache lines, so the write-combining buffers are always flushed full
+	// whatever order the handles come in.
+	std::uint8_t* base = static_cast<std::uint8_t*>(dest);
+	for (Handle handle : handles)
+	{
+		float* out = reinterpret_cast<float*>(base + handle * stride);
+
+		// Objects at rest have equal matrices, and a whole step needs no blend.
+		if (alpha >= 1.0f || (mDirtyFrames[handle] & MovingBit) == 0)
+			streamTransposed(mWorld[handle], out);
+		else
+			streamTransposedLerp(mPrevWorld[handle], mWorld[handle], alpha, out);
+
+		streamTransposed(mTexTransform[handle], out + 16);
+	}
+
+#if defined(_XM_SSE_INTRINSICS_)
+	// Streaming stores are weakly ordered; make them visible before the frame
+	// that reads them is submitted.
+	_mm_sfence();
+#endif
+}
+
+bool ObjectTransforms::isDirty(Handle handle, int frameResource) const
+{
+	return (mDirtyFrames[handle] & (1u << frameResource)) != 0;
+}
+
+ObjectTransforms::HandleRange ObjectTransforms::getDirty(int frameResource) const
+{
+	const DirtyList& list = *mDirtyLists[frameResource];
+
+	HandleRange range;
+	range.First = list.Handles.data();
+	range.Last = range.First + list.Count.load();
+	return range;
+}
+
+void ObjectTransforms::clearDirty(int frameResource)
+{
+	DirtyList& list = *mDirtyLists[frameResource];
+
+	const std::uint32_t count = list.Count.load();
+	for (std::uint32_t i = 0; i < count; ++i)
+		mDirtyFrames[list.Handles[i]] &= ~(1u << frameResource);
+
+	list.Count = 0;
+}
+
+void ObjectTransforms::markAllDirty(int frameResource)
+{
+	for (Handle handle = 0; handle < (Handle)mWorld.size(); ++handle)
+		markDirty(handle, 1u << frameResource);
+}
+
+void ObjectTransforms::resetInterpolation(Handle handle)
+{
+	mPrevWorld[handle] = mWorld[handle];
+
+	if ((mDirtyFrames[handle] & MovingBit) == 0)
+		return;
+
+	// Jumps are rare, so finding the handle in the moving list is cheap
+	// enough; the last one listed takes its place.
+	mDirtyFrames[handle] &= ~MovingBit;
+	const std::uint32_t count = mMoving.Count.load();
+	for (std::uint32_t i = 0; i < count; ++i)
+	{
+		if (mMoving.Handles[i] == handle)
+		{
+			mMoving.Handles[i] = mMoving.Handles[count - 1];
+			mMoving.Count = count - 1;
+			break;
+		}
+	}
+}
+
+void ObjectTransforms::markMoving(Handle handle)
+{
+	if (mDirtyFrames[handle] & MovingBit)
+		return;
+
+	mDirtyFrames[handle] |= MovingBit;
+	mMoving.Handles[mMoving.Count++] = handle;
+}
+
+void ObjectTransforms::markDirty(Handle handle, std::uint32_t frames)
+{
+	// Only frame resources that do not list the object yet need it appended.
+	// Each handle is only ever touched by one thread at a time, so the bits need
+	// no synchronisation; the lists are shared and are appended to atomically.
+	std::uint32_t added = frames & ~mDirtyFrames[handle];
+	mDirtyFrames[handle] |= frames;
+
+	for (int frame = 0; added != 0; ++frame, added >>= 1)
+	{
+		if (added & 1u)
+		{
+			DirtyList& list = *mDirtyLists[frame];
+			list.Handles[list.Count++] = handle;
+		}
+	}
+}
@@ -0,0 +1,127 @@
+#pragma once
+
+#include "../../Common/MathHelper.h"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+using namespace DirectX;
+
+// Packed per-object constants, indexed by the same handle a RenderItem uses as
+// its ObjCBIndex.  Entities write their world matrix here in place.  Every
+// frame resource keeps a list of the objects whose copy it holds is stale, so
+// uploading touches only what changed.  The world matrix from before the
+// latest simulation step is kept as well, so frames drawn between steps can
+// interpolate.
+class ObjectTransforms
+{
+public:
+	typedef std::uint32_t Handle;
+	static const Handle InvalidHandle = UINT32_MAX;
+
+	struct HandleRange
+	{
+		const Handle*		First;
+		const Handle*		Last;
+
+		const Handle*		begin() const { return First; }
+		const Handle*		end() const { return Last; }
+		std::size_t			size() const { return Last - First; }
+	};
+
+
+public:
+	explicit ObjectTransforms(int frameResourceCount);
+	ObjectTransforms(const ObjectTransforms& rhs) = delete;
+	ObjectTransforms& operator=(const ObjectTransforms& rhs) = delete;
+
+	// Changes how many frame resources are tracked.  Only while empty.
+	void					setFrameResourceCount(int frameResourceCount);
+
+	// Reuses a removed slot when one is available.
+	Handle					add(FXMMATRIX world, CXMMATRIX texTransform);
+	void					remove(Handle handle);
+	void					reserve(std::size_t count);
+	std::size_t				size() const;
+
+	// Safe to call for different handles from several threads at once.
+	void					setWorld(Handle handle, FXMMATRIX world);
+	void					setTexTransform(Handle handle, FXMMATRIX texTransform);
+
+	const XMFLOAT4X4&		getWorld(Handle handle) const;
+	const XMFLOAT4X4&		getPreviousWorld(Handle handle) const;
+	const XMFLOAT4X4&		getTexTransform(Handle handle) const;
+
+	// Call before every simulation step.  Objects that moved in the previous
+	// step come to rest at their current world matrix unless moved again.
+	void					beginStep();
+
+	// Objects whose world matrix was set since the last beginStep.
+	HandleRange				getMoving() const;
+
+	// Marks every moving object out of date in the given frame resource.  Their
+	// interpolated world matrix changes every frame, not only every step.
+	void					markMovingDirty(int frameResource);
+
+	// For an object that jumped instead of moving, such as one wrapped around
+	// to the far end of the scene: its current world matrix becomes its
+	// previous one too, so frames between steps draw it where it is instead
+	// of blending across the jump.  Call after its last setWorld of the step.
+	void					resetInterpolation(Handle handle);
+
+	// Writes the transposed World and TexTransform of every listed object to
+	// dest + handle * stride, laid out like ObjectConstants.  World is blended
+	// from the previous to the current world matrix by alpha.  Meant for
+	// write-combined upload memory: each element is written whole with 16-byte
+	// non-temporal stores and never read back.  dest and stride must be
+	// multiples of 16.
+	void					streamConstants(HandleRange handles, void* dest, std::size_t stride, float alpha = 1.0f) const;
+
+	// Whether the copy held by the given frame resource is out of date.
+	bool					isDirty(Handle handle, int frameResource) const;
+
+	// Objects whose copy in the given frame resource is out of date, each listed
+	// once.  Removed objects may still be listed; uploading them is harmless.
+	HandleRange				getDirty(int frameResource) const;
+
+	// Marks every listed object up to date in the given frame resource.
+	void					clearDirty(int frameResource);
+
+	// Marks every object out of date in the given frame resource, for when its
+	// copy of the data was lost.
+	void					markAllDirty(int frameResource);
+
+
+private:
+	struct DirtyList
+	{
+		// Sized to hold every object, so appending needs no lock.
+		std::vector<Handle>			Handles;
+		std::atomic<std::uint32_t>	Count;
+	};
+
+
+private:
+	void					markDirty(Handle handle, std::uint32_t frames);
+	void					markMoving(Handle handle);
+
+
+private:
+	std::vector<XMFLOAT4X4>		mWorld;
+	std::vector<XMFLOAT4X4>		mPrevWorld;
+	std::vector<XMFLOAT4X4>		mTexTransform;
+
+	// One bit per frame resource, plus MovingBit.  A set bit means the object is
+	// in that frame resource's dirty list, or in mMoving; removing an object
+	// leaves its bits alone so that a reused handle is never listed twice.
+	std::vector<std::uint32_t>	mDirtyFrames;
+	std::uint32_t				mAllFrames;
+
+	static const std::uint32_t	MovingBit = 1u << 31;
+
+	std::vector<std::unique_ptr<DirtyList>>	mDirtyLists;
+	DirtyList					mMoving;
+
+	std::vector<Handle>			mFreeHandles;
+};
@@ -0,0 +1,65 @@
+#include "RecordingCommandList.h"
+
+
+void RecordingCommandList::setPipelineState(PsoHandle pso)
+{
+	record(Command::SetPipelineState, pso.Index);
+}
+
+void RecordingCommandList::setMaterial(MaterialHandle material)
+{
+	record(Command::SetMaterial, material.Index);
+}
+
+void RecordingCommandList::setMesh(MeshHandle mesh)
+{
+	record(Command::SetMesh, mesh.Index);
+}
+
+void RecordingCommandList::setPrimitiveTopology(std::uint32_t topology)
+{
+	record(Command::SetPrimitiveTopology, topology);
+}
+
+void RecordingCommandList::drawIndexedInstanced(std::uint32_t indexCount, std::uint32_t instanceCount,
+	std::uint32_t startIndexLocation, std::int32_t baseVertexLocation, std::uint32_t firstInstance)
+{
+	record(Command::DrawIndexedInstanced, indexCount);
+
+	Command& command = mCommands.back();
+	command.InstanceCount = instanceCount;
+	command.StartIndexLocation = startIndexLocation;
+	command.BaseVertexLocation = baseVertexLocation;
+	command.FirstInstance = firstInstance;
+}
+
+void RecordingCommandList::clear()
+{
+	mCommands.clear();
+	for (std::uint32_t& count : mCounts)
+		count = 0;
+}
+
+const std::vector<RecordingCommandList::Command>& RecordingCommandList::getCommands() const
+{
+	return mCommands;
+}
+
+std::uint32_t RecordingCommandList::count(Command::Type type) const
+{
+	return mCounts[type];
+}
+
+void RecordingCommandList::record(Command::Type type, std::uint32_t value)
+{
+	Command command;
+	command.Kind = type;
+	command.Value = value;
+	command.InstanceCount = 0;
+	command.StartIndexLocation = 0;
+	command.BaseVertexLocation = 0;
+	command.FirstInstance = 0;
+
+	mCommands.push_back(command);
+	++mCounts[type];
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "DrawCommandList.h"
+#include <cstdint>
+#include <vector>
+
+// Stand-in command list that stores every call instead of talking to a GPU.
+// Used to check and measure what a DrawQueue emits.
+class RecordingCommandList : public DrawCommandList
+{
+public:
+	struct Command
+	{
+		enum Type
+		{
+			SetPipelineState,
+			SetMaterial,
+			SetMesh,
+			SetPrimitiveTopology,
+			DrawIndexedInstanced,
+			TypeCount
+		};
+
+		Type				Kind;
+
+		// The handle index or value that was set, or the index count of a draw.
+		std::uint32_t		Value;
+
+		// Draws only.
+		std::uint32_t		InstanceCount;
+		std::uint32_t		StartIndexLocation;
+		std::int32_t		BaseVertexLocation;
+		std::uint32_t		FirstInstance;
+	};
+
+
+public:
+	virtual void			setPipelineState(PsoHandle pso) override;
+	virtual void			setMaterial(MaterialHandle material) override;
+	virtual void			setMesh(MeshHandle mesh) override;
+	virtual void			setPrimitiveTopology(std::uint32_t topology) override;
+	virtual void			drawIndexedInstanced(std::uint32_t indexCount, std::uint32_t instanceCount,
+								std::uint32_t startIndexLocation, std::int32_t baseVertexLocation,
+								std::uint32_t firstInstance) override;
+
+	void					clear();
+	const std::vector<Command>&	getCommands() const;
+	std::uint32_t			count(Command::Type type) const;
+
+
+private:
+	void					record(Command::Type type, std::uint32_t value);
+
+
+private:
+	std::vector<Command>	mCommands;
+	std::uint32_t			mCounts[Command::TypeCount] = {};
+};
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "CommandRecorder.h"
+#include "FrameFence.h"
+#include "ObjectTransforms.h"
+#include <cstddef>
+#include <cstdint>
+
+// The buffers the CPU fills for the GPU.  Every frame resource has its own
+// copy.  Object data and material constants persist and are updated element
+// by element; pass constants and instance indices are written whole every frame.
+enum class FrameBuffer : int
+{
+	PassConstants = 0,
+	MaterialConstants,
+	ObjectData,
+	InstanceIndices,
+	Count
+};
+
+// Everything the Scene needs from a graphics backend to load its meshes and to
+// build and submit a frame.  World implements it on D3D12; NullRenderDevice
+// implements it in memory so the frame path can run without a GPU.
+class RenderDevice
+{
+public:
+	virtual					~RenderDevice() {}
+
+	// Load time.  Creates the GPU vertex and index buffers of a mesh from CPU
+	// data; draws refer to them by the mesh's handle.  Indices are 16 bit.
+	virtual void			createMeshBuffers(MeshHandle mesh, const void* vertices, std::uint32_t vertexBytes,
+								std::uint32_t vertexStride, const void* indices, std::uint32_t indexBytes) = 0;
+
+	// Load time.  Creates count frame resources, each with per-frame buffers
+	// for the given number of objects and materials.
+	virtual void			createFrameResources(int count, std::uint32_t objectCount, std::uint32_t materialCount) = 0;
+
+	// The fence endFrame's work is signalled on, for the FrameScheduler.
+	virtual FrameFence&		fence() = 0;
+
+	// Makes the frame resource the one that uploads and recording go to.  The
+	// GPU must be done with it; the FrameScheduler waits for that.
+	virtual void			beginFrame(int frameResource) = 0;
+
+	// Makes room for count objects in the current frame resource's object data.
+	// Returns true if that lost the previous contents, in which case every
+	// object has to be uploaded again for this frame resource.
+	virtual bool			reserveObjects(std::uint32_t count) = 0;
+
+	// Copies one element into a persistent buffer of the current frame resource
+	// (ObjectData or MaterialConstants).  size must match its element type.
+	virtual void			upload(FrameBuffer buffer, std::uint32_t element, const void* data, std::size_t size) = 0;
+
+	// Writes the constants of every listed object straight into the current
+	// frame resource's object data in one pass, with world matrices
+	// interpolated by alpha between the last two simulation steps.  Preferred
+	// over upload() when more than a handful of objects changed.
+	virtual void			uploadObjects(const ObjectTransforms& objects, ObjectTransforms::HandleRange handles, float alpha) = 0;
+
+	// Replaces this frame's copy of a per-frame buffer (PassConstants or
+	// InstanceIndices) with size bytes of data.
+	virtual void			uploadFrameData(FrameBuffer buffer, const void* data, std::size_t size) = 0;
+
+	// Starts the frame by clearing the back buffer and depth buffer.
+	virtual void			clear(const float color[4]) = 0;
+
+	// Hands out the command lists the draws are recorded into.
+	virtual CommandRecorder&	recorder() = 0;
+
+	// Submits the clear and the first listCount recorded lists, in order, and
+	// presents the frame.  Signal the fence after this to fence the frame off.
+	virtual void			endFrame(unsigned listCount) = 0;
+};
@@ -0,0 +1,120 @@
+#include "Replay.h"
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <sstream>
+#include <vector>
+
+
+Replay::Replay(World& world, const InputScript& input)
+	: mWorld(world)
+	, mInput(input)
+	, mMouseDown(false)
+{
+}
+
+bool Replay::parseCommandLine(const std::string& cmdLine, Options& options)
+{
+	std::istringstream args(cmdLine);
+	bool replay = false;
+
+	std::string arg;
+	while (args >> arg)
+	{
+		bool valid;
+		if (arg == "--replay")
+		{
+			replay = true;
+			valid = (args >> options.Frames) && options.Frames > 0;
+		}
+		else if (arg == "--dt")
+			valid = (args >> options.FrameTime) && options.FrameTime > 0.0;
+		else if (arg == "--input")
+			valid = (bool)(args >> options.InputPath);
+		else if (arg == "--out")
+			valid = (bool)(args >> options.OutputPath);
+		else
+			valid = false;
+
+		if (!valid)
+			return false;
+	}
+
+	return replay;
+}
+
+void Replay::run(const Options& options, std::ostream& out)
+{
+	mWorld.UseScriptedInput(true);
+	mMouseDown = false;
+
+	std::vector<double> frameTimes;
+	frameTimes.reserve(options.Frames);
+
+	out << "frame,cpu_ms,hash\n";
+	out << std::setfill('0');
+
+	for (int frame = 0; frame < options.Frames; ++frame)
+	{
+		applyInput((std::uint32_t)frame);
+
+		auto start = std::chrono::steady_clock::now();
+		mWorld.RunFrame(options.FrameTime);
+		auto end = std::chrono::steady_clock::now();
+
+		// Hashing is left out of the timing; it is not part of a real frame.
+		double ms = std::chrono::duration<double, std::milli>(end - start).count();
+		frameTimes.push_back(ms);
+
+		out << frame << ',' << std::fixed << std::setprecision(4) << ms << ','
+			<< std::hex << std::setw(16) << mWorld.GetScene().HashRenderItems() << std::dec << '\n';
+	}
+
+	if (frameTimes.empty())
+		return;
+
+	const std::uint64_t finalHash = mWorld.GetScene().HashRenderItems();
+
+	double total = 0.0;
+	for (double ms : frameTimes)
+		total += ms;
+
+	std::sort(frameTimes.begin(), frameTimes.end());
+	auto percentile = [&](double p) { return frameTimes[(std::size_t)(p * (frameTimes.size() - 1))]; };
+
+	out << std::setprecision(4);
+	out << "# frames " << frameTimes.size() << ", dt " << options.FrameTime << " s\n";
+	out << "# cpu_ms mean " << total / frameTimes.size()
+		<< " min " << frameTimes.front()
+		<< " p50 " << percentile(0.5)
+		<< " p99 " << percentile(0.99)
+		<< " max " << frameTimes.back() << '\n';
+	out << "# hash " << std::hex << std::setw(16) << finalHash << std::dec << '\n';
+}
+
+void Replay::applyInput(std::uint32_t frame)
+{
+	for (const InputScript::Event& event : mInput.eventsAt(frame))
+	{
+		switch (event.Kind)
+		{
+		case InputScript::Event::KeyDown:
+			mWorld.SetKeyDown(event.Key, true);
+			break;
+		case InputScript::Event::KeyUp:
+			mWorld.SetKeyDown(event.Key, false);
+			break;
+		case InputScript::Event::MouseDown:
+			mMouseDown = true;
+			mWorld.OnMouseDown(MK_LBUTTON, event.X, event.Y);
+			break;
+		case InputScript::Event::MouseUp:
+			mMouseDown = false;
+			mWorld.OnMouseUp(0, event.X, event.Y);
+			break;
+		case InputScript::Event::MouseMove:
+			mWorld.OnMouseMove(mMouseDown ? MK_LBUTTON : 0, event.X, event.Y);
+			break;
+		}
+	}
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "InputScript.h"
+#include "World.h"
+#include <ostream>
+#include <string>
+
+// Drives a headless World for a fixed number of frames of fixed length,
+// feeding it scripted input instead of the keyboard and mouse.  Every frame's
+// CPU time is reported along with a hash of the scene after it, so the same
+// run is both a benchmark and a check that an optimisation changed nothing.
+class Replay
+{
+public:
+	struct Options
+	{
+		int Frames = 600;
+		double FrameTime = 1.0 / 60.0;
+		std::string InputPath;
+		std::string OutputPath;
+	};
+
+
+public:
+	Replay(World& world, const InputScript& input);
+	Replay(const Replay& rhs) = delete;
+	Replay& operator=(const Replay& rhs) = delete;
+
+	// Reads "--replay FRAMES [--dt SECONDS] [--input FILE] [--out FILE]".
+	// Returns false when the command line does not ask for a replay or does
+	// not parse.
+	static bool				parseCommandLine(const std::string& cmdLine, Options& options);
+
+	// Runs the frames and writes one "frame,cpu_ms,hash" line for each, then
+	// a summary as # comments.  The world must be initialised headless.
+	void					run(const Options& options, std::ostream& out);
+
+
+private:
+	void					applyInput(std::uint32_t frame);
+
+
+private:
+	World&					mWorld;
+	const InputScript&		mInput;
+	bool					mMouseDown;
+};
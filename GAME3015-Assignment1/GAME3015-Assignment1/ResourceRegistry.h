@@ -0,0 +1,95 @@
+#pragma once
+
+#include <cassert>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// 32-bit index into a ResourceRegistry.  The tag makes handles of different
+// resource kinds distinct types so they cannot be mixed up.
+template<typename Tag>
+struct ResourceHandle
+{
+	static const std::uint32_t InvalidIndex = UINT32_MAX;
+
+	std::uint32_t Index = InvalidIndex;
+
+	bool IsValid() const { return Index != InvalidIndex; }
+
+	bool operator==(ResourceHandle rhs) const { return Index == rhs.Index; }
+	bool operator!=(ResourceHandle rhs) const { return Index != rhs.Index; }
+};
+
+struct PsoTag;
+struct MaterialTag;
+struct MeshTag;
+
+typedef ResourceHandle<PsoTag>		PsoHandle;
+typedef ResourceHandle<MaterialTag>	MaterialHandle;
+typedef ResourceHandle<MeshTag>		MeshHandle;
+
+// Interns names once at load time and hands out handles that index a dense
+// array.  Only the load-time and tooling paths should call find(); per-frame
+// code keeps the handles and uses get().
+template<typename T, typename Handle>
+class ResourceRegistry
+{
+public:
+	Handle add(const std::string& name, const T& item)
+	{
+		assert(mLookup.find(name) == mLookup.end());
+
+		Handle handle;
+		handle.Index = (std::uint32_t)mItems.size();
+
+		mItems.push_back(item);
+		mNames.push_back(name);
+		mLookup[name] = handle.Index;
+		return handle;
+	}
+
+	// Returns an invalid handle if the name was never registered.
+	Handle find(const std::string& name) const
+	{
+		Handle handle;
+		auto found = mLookup.find(name);
+		if (found != mLookup.end())
+			handle.Index = found->second;
+		return handle;
+	}
+
+	T& get(Handle handle)
+	{
+		assert(handle.Index < mItems.size());
+		return mItems[handle.Index];
+	}
+
+	const T& get(Handle handle) const
+	{
+		assert(handle.Index < mItems.size());
+		return mItems[handle.Index];
+	}
+
+	const std::string& name(Handle handle) const
+	{
+		return mNames[handle.Index];
+	}
+
+	std::size_t size() const
+	{
+		return mItems.size();
+	}
+
+	// Dense storage, in registration order.
+	typename std::vector<T>::iterator begin() { return mItems.begin(); }
+	typename std::vector<T>::iterator end() { return mItems.end(); }
+	typename std::vector<T>::const_iterator begin() const { return mItems.begin(); }
+	typename std::vector<T>::const_iterator end() const { return mItems.end(); }
+
+
+private:
+	std::vector<T>									mItems;
+	std::vector<std::string>						mNames;
+	std::unordered_map<std::string, std::uint32_t>	mLookup;
+};
@@ -0,0 +1,783 @@
+#include "Scene.h"
+#include "../../Common/FixedTimestep.h"
+#include "../../Common/GeometryGenerator.h"
+#include <algorithm>
+#include <cassert>
+
+
+
+const int gNumFrameResources = 3;
+
+Scene::Scene(int framesInFlight)
+	: mFramesInFlight(framesInFlight)
+	, mObjects(framesInFlight)
+	, mSceneGraph(mTransforms)
+	, mFrameArena(1 << 20)
+	, mStopSimulation(false)
+	, mRenderObjects(framesInFlight)
+{
+	// Registered in draw order; the handles order the draws.
+	mOpaquePso = mPsoTable.add("opaque", RenderLayer::Opaque);
+	mTransparentPso = mPsoTable.add("transparent", RenderLayer::Transparent);
+	mAlphaTestedPso = mPsoTable.add("alphaTested", RenderLayer::AlphaTested);
+
+	//mCamera.SetPosition(0.8f * scaleFactor, 0.3 * scaleFactor, 1.0f * scaleFactor);
+	mCamera.SetPosition(0, 5, 0);
+	mCamera.Pitch(3.14 / 2);
+	Resize(mRenderTargetWidth, mRenderTargetHeight);
+}
+
+Scene::~Scene()
+{
+	StopSimulationThread();
+}
+
+void Scene::Build(RenderDevice& device)
+{
+	// rand is left unseeded so a replay hashes the same on every run.
+	mRenderDevice = &device;
+
+	BuildGroundGeometry();
+	BuildMaterials();
+	BuildRenderItems();
+	BuildFrameResources();
+
+	if (mSimulationThreadEnabled)
+		mSimulationThread = std::thread(&Scene::SimulationLoop, this);
+}
+
+void Scene::EnableSimulationThread(float stepSeconds)
+{
+	// The snapshot buffers take the place of the frame resources as the
+	// consumers of mObjects' dirty lists; the frame resources use mRenderObjects.
+	mObjects.setFrameResourceCount(TripleBuffer<SceneSnapshot>::BufferCount);
+
+	mSimulationThreadEnabled = true;
+	mSimulationStep = stepSeconds;
+
+	// One job per scene layer, kept off the pool the render thread records with.
+	mSimulationPool = std::make_unique<ThreadPool>((unsigned)LayerCount);
+}
+
+void Scene::Resize(int width, int height)
+{
+	mRenderTargetWidth = width;
+	mRenderTargetHeight = height;
+	mCamera.SetLens(0.25f*MathHelper::Pi, (float)width / height, 1.0f, 1000.0f);
+}
+
+void Scene::Step(float dt)
+{
+	// The simulation thread does its own stepping.
+	if (!mSimulationThreadEnabled)
+		Simulate(dt);
+}
+
+void Scene::Simulate(float dt)
+{
+	mObjects.beginStep();
+
+	// Everything below the scene graph sees the step through this context.
+	mFrameArena.reset();
+	mSimulationTime += dt;
+
+	FrameContext frame;
+	frame.DeltaTime = dt;
+	frame.TotalTime = (float)mSimulationTime;
+	frame.FrameIndex = mFrameCount++;
+	frame.Arena = &mFrameArena;
+	frame.Commands = &mSceneCommands;
+
+	UpdateGameObjects(frame);
+
+	// Sync point: no update job is walking the graph any more.
+	ApplySceneCommands();
+}
+
+void Scene::Update(float totalTime, float deltaTime, float stepAlpha)
+{
+	// Pick the next frame resource, but leave waiting for the GPU to release
+	// it until just before it is written.  This only reorders the wait: it
+	// still blocks this thread, and all that runs ahead of it is the snapshot
+	// hand-over below.  The simulation step has already run by now whether or
+	// not the GPU is done.
+	mCurrFrameResourceIndex = mFrameScheduler.beginFrame();
+
+	if (mSimulationThreadEnabled)
+		ReceiveSnapshot();
+	else
+		mRenderAlpha = stepAlpha;
+
+	// From here on the frame resource is written to.
+	mFrameScheduler.waitReady();
+	mRenderDevice->beginFrame(mCurrFrameResourceIndex);
+
+	UpdateObjectCBs();
+	UpdateMaterialCBs();
+	UpdateMainPassCB(totalTime, deltaTime);
+}
+
+void Scene::Draw()
+{
+	mRenderDevice->clear((float*)&mMainPassCB.FogColor);
+
+	// Passes are numbered in the order they have to be drawn in.
+	std::vector<RenderItem*>* layers = GetDrawLayers();
+	mDrawQueue.clear();
+	QueueRenderItems(0, mOpaquePso, false, layers[(int)RenderLayer::Opaque]);
+	QueueRenderItems(1, mAlphaTestedPso, false, layers[(int)RenderLayer::AlphaTested]);
+	QueueRenderItems(2, mTransparentPso, true, layers[(int)RenderLayer::Transparent]);
+	mDrawQueue.sort();
+
+	// The draws index this list, so it has to be in place before the command lists execute.
+	const std::vector<std::uint32_t>& instanceObjects = mDrawQueue.getInstanceObjects();
+	mRenderDevice->uploadFrameData(FrameBuffer::InstanceIndices, instanceObjects.data(),
+		instanceObjects.size() * sizeof(std::uint32_t));
+
+	// Each pass, or chunk of a large pass, is recorded on its own thread.
+	const std::size_t packetsPerChunk = 256;
+	mDrawStats = mDrawQueue.record(mRenderDevice->recorder(), mUpdatePool, packetsPerChunk);
+
+	mRenderDevice->endFrame(mDrawStats.Lists);
+
+	// The frame resource stays in use until the GPU gets through this frame.
+	mFrameScheduler.endFrame();
+}
+
+Camera& Scene::GetCamera()
+{
+	return mCamera;
+}
+
+const Material& Scene::GetMaterial(MaterialHandle handle) const
+{
+	return *mMaterialTable.get(handle);
+}
+
+const ResourceRegistry<RenderLayer, PsoHandle>& Scene::GetPsoTable() const
+{
+	return mPsoTable;
+}
+
+ThreadPool& Scene::GetThreadPool()
+{
+	return mUpdatePool;
+}
+
+void Scene::MarkMaterialDirty(MaterialHandle handle)
+{
+	Material* mat = mMaterialTable.get(handle);
+	if (mat->NumFramesDirty <= 0)
+		mDirtyMaterials.push_back(handle);
+
+	mat->NumFramesDirty = mFramesInFlight;
+}
+
+const DrawQueue::Stats& Scene::GetDrawStats() const
+{
+	return mDrawStats;
+}
+
+const FrameScheduler::Stats& Scene::GetFrameStats() const
+{
+	return mFrameScheduler.getStats();
+}
+
+std::size_t Scene::GetRenderItemCount() const
+{
+	return mAllRitems.size();
+}
+
+std::uint64_t Scene::HashRenderItems() const
+{
+	std::uint64_t hash = 14695981039346656037ull;
+	for (const auto& ri : mAllRitems)
+	{
+		const XMFLOAT4X4& world = mObjects.getWorld(ri->ObjCBIndex);
+		const unsigned char* bytes = reinterpret_cast<const unsigned char*>(&world);
+		for (std::size_t i = 0; i < sizeof(world); ++i)
+		{
+			hash ^= bytes[i];
+			hash *= 1099511628211ull;
+		}
+	}
+	return hash;
+}
+
+void Scene::UpdateObjectCBs()
+{
+	// Objects spawned since this frame resource was last used may not fit.
+	ObjectTransforms& objects = GetDrawObjects();
+	if (mRenderDevice->reserveObjects((std::uint32_t)objects.size()))
+		objects.markAllDirty(mCurrFrameResourceIndex);
+
+	// Objects still moving are drawn part way between their last two steps,
+	// which differs from frame to frame.
+	if (mRenderAlpha < 1.0f)
+		objects.markMovingDirty(mCurrFrameResourceIndex);
+
+	// Only objects that changed since this frame resource was last used are
+	// listed, so a mostly static scene costs next to nothing here.  They are
+	// transposed and written straight into the mapped buffer in one pass.
+	mRenderDevice->uploadObjects(objects, objects.getDirty(mCurrFrameResourceIndex), mRenderAlpha);
+
+	// The other FrameResources keep their own dirty lists.
+	objects.clearDirty(mCurrFrameResourceIndex);
+}
+
+void Scene::UpdateMaterialCBs()
+{
+	// Only materials marked dirty are visited.  A material stays listed until
+	// every FrameResource has a fresh copy.
+	std::size_t kept = 0;
+	for (MaterialHandle handle : mDirtyMaterials)
+	{
+		Material* mat = mMaterialTable.get(handle);
+		XMMATRIX matTransform = XMLoadFloat4x4(&mat->MatTransform);
+
+		MaterialConstants matConstants;
+		matConstants.DiffuseAlbedo = mat->DiffuseAlbedo;
+		matConstants.FresnelR0 = mat->FresnelR0;
+		matConstants.Roughness = mat->Roughness;
+		XMStoreFloat4x4(&matConstants.MatTransform, XMMatrixTranspose(matTransform));
+
+		mRenderDevice->upload(FrameBuffer::MaterialConstants, mat->MatCBIndex, &matConstants, sizeof(matConstants));
+
+		// Next FrameResource need to be updated too.
+		if (--mat->NumFramesDirty > 0)
+			mDirtyMaterials[kept++] = handle;
+	}
+	mDirtyMaterials.resize(kept);
+}
+
+void Scene::UpdateMainPassCB(float totalTime, float deltaTime)
+{
+	// Picks up whatever moved the camera since the last frame.
+	mCamera.UpdateViewMatrix();
+
+	XMMATRIX view = mCamera.GetView();
+	XMMATRIX proj = mCamera.GetProj();
+
+	XMMATRIX viewProj = XMMatrixMultiply(view, proj);
+	XMVECTOR viewDet = XMMatrixDeterminant(view);
+	XMVECTOR projDet = XMMatrixDeterminant(proj);
+	XMVECTOR viewProjDet = XMMatrixDeterminant(viewProj);
+	XMMATRIX invView = XMMatrixInverse(&viewDet, view);
+	XMMATRIX invProj = XMMatrixInverse(&projDet, proj);
+	XMMATRIX invViewProj = XMMatrixInverse(&viewProjDet, viewProj);
+
+	XMStoreFloat4x4(&mMainPassCB.View, XMMatrixTranspose(view));
+	XMStoreFloat4x4(&mMainPassCB.InvView, XMMatrixTranspose(invView));
+	XMStoreFloat4x4(&mMainPassCB.Proj, XMMatrixTranspose(proj));
+	XMStoreFloat4x4(&mMainPassCB.InvProj, XMMatrixTranspose(invProj));
+	XMStoreFloat4x4(&mMainPassCB.ViewProj, XMMatrixTranspose(viewProj));
+	XMStoreFloat4x4(&mMainPassCB.InvViewProj, XMMatrixTranspose(invViewProj));
+	mMainPassCB.EyePosW = mCamera.GetPosition3f();
+	mMainPassCB.RenderTargetSize = XMFLOAT2((float)mRenderTargetWidth, (float)mRenderTargetHeight);
+	mMainPassCB.InvRenderTargetSize = XMFLOAT2(1.0f / mRenderTargetWidth, 1.0f / mRenderTargetHeight);
+	mMainPassCB.NearZ = 1.0f;
+	mMainPassCB.FarZ = 1000.0f;
+	mMainPassCB.TotalTime = totalTime;
+	mMainPassCB.DeltaTime = deltaTime;
+	mMainPassCB.AmbientLight = { 0.25f, 0.25f, 0.35f, 1.0f };
+	mMainPassCB.Lights[0].Direction = { 0.57735f, -0.57735f, 0.57735f };
+	mMainPassCB.Lights[0].Strength = { 0.6f, 0.6f, 0.6f };
+	mMainPassCB.Lights[1].Direction = { -0.57735f, -0.57735f, 0.57735f };
+	mMainPassCB.Lights[1].Strength = { 0.3f, 0.3f, 0.3f };
+	mMainPassCB.Lights[2].Direction = { 0.0f, -0.707f, -0.707f };
+	mMainPassCB.Lights[2].Strength = { 0.15f, 0.15f, 0.15f };
+	mMainPassCB.Lights[3].Position = { -5.0f  , 3.0f , 0.0f  };
+	mMainPassCB.Lights[3].Strength = { 1.0f, 0.0f, 0.0f };
+	mMainPassCB.Lights[3].Direction = { 0.0, -1.0, 0.0f };
+	mMainPassCB.Lights[3].FalloffStart = { 1.0f   };
+	mMainPassCB.Lights[3].FalloffEnd = { 5.0f  };
+	mMainPassCB.Lights[3].SpotPower = { 1.0f };
+
+
+	mRenderDevice->uploadFrameData(FrameBuffer::PassConstants, &mMainPassCB, sizeof(mMainPassCB));
+}
+
+void Scene::UpdateGameObjects(const FrameContext& frame)
+{
+	if (XMVectorGetX(mPlane->getPosition()) > 1.8 || XMVectorGetX(mPlane->getPosition()) < -1.8)
+	{
+		mPlane->setVelocity(-mPlane->getVelocity());
+		leftPlane->setVelocity(-leftPlane->getVelocity());
+		rightPlane->setVelocity(-rightPlane->getVelocity());
+	}
+
+	bool backgroundWrapped = false;
+	if (XMVectorGetZ(background->getPosition()) < -12)
+	{
+		background->setPosition(XMVectorSetZ(background->getPosition(), 12));
+		backgroundWrapped = true;
+	}
+
+	bool background2Wrapped = false;
+	if (XMVectorGetZ(background2->getPosition()) < -12)
+	{
+		background2->setPosition(XMVectorSetZ(background2->getPosition(), 12));
+		background2Wrapped = true;
+	}
+
+	ThreadPool& pool = mSimulationPool ? *mSimulationPool : mUpdatePool;
+
+	// Integrate velocities and recompose world matrices in two sweeps over
+	// the transform store, split into slot ranges on the pool, before any node
+	// reads its world transform.
+	mTransforms.integrate(frame.DeltaTime, pool);
+	mTransforms.updateWorldTransforms(pool);
+
+	// Apply movements.  Each layer's subtree is independent, so they are
+	// handed to the update pool and finished before the constant buffers are touched.
+	SceneNode::beginUpdate();
+	mSceneGraph.updateParallel(frame, mObjects, pool, 2);
+	pool.wait();
+	SceneNode::endUpdate();
+
+	// A wrapped tile jumped from one end of the scene to the other.  Blended
+	// from where it was, it would sweep across the whole scene.
+	if (backgroundWrapped)
+		SnapObject(background->renderHandle);
+	if (background2Wrapped)
+		SnapObject(background2->renderHandle);
+}
+
+void Scene::SnapObject(ObjectTransforms::Handle handle)
+{
+	mObjects.resetInterpolation(handle);
+
+	if (handle >= mSnappedStep.size())
+		mSnappedStep.resize(mObjects.size(), 0);
+	mSnappedStep[handle] = mFrameCount;
+}
+
+void Scene::ApplySceneCommands()
+{
+	if (mSceneCommands.empty())
+		return;
+
+	mReleasedObjects.clear();
+	mSceneCommands.apply(&mReleasedObjects);
+
+	if (!mReleasedObjects.empty())
+		RemoveRenderItems(mReleasedObjects);
+}
+
+void Scene::RemoveRenderItems(const std::vector<ObjectTransforms::Handle>& handles)
+{
+	std::vector<bool> removed(mObjects.size(), false);
+	for (ObjectTransforms::Handle handle : handles)
+	{
+		removed[handle] = true;
+		mObjects.remove(handle);
+	}
+
+	auto isRemoved = [&](const RenderItem* ri) { return removed[ri->ObjCBIndex]; };
+
+	for (auto& layer : mRitemLayer)
+		layer.erase(std::remove_if(layer.begin(), layer.end(), isRemoved), layer.end());
+
+	mAllRitems.erase(std::remove_if(mAllRitems.begin(), mAllRitems.end(),
+		[&](const std::unique_ptr<RenderItem>& ri) { return isRemoved(ri.get()); }), mAllRitems.end());
+
+	++mRenderItemsVersion;
+}
+
+void Scene::SimulationLoop()
+{
+	typedef std::chrono::steady_clock Clock;
+
+	FixedTimestep clock(mSimulationStep);
+	Clock::time_point last = Clock::now();
+
+	while (!mStopSimulation.load())
+	{
+		Clock::time_point now = Clock::now();
+		int steps = clock.advance(std::chrono::duration<double>(now - last).count());
+		last = now;
+
+		for (int i = 0; i < steps; ++i)
+			Simulate(clock.step());
+
+		// The state is that of the last step that was due, a fraction of a
+		// step ago.  Publishing never waits for the render thread.
+		if (steps > 0)
+		{
+			std::chrono::duration<double> behind(clock.alpha() * clock.step());
+			PublishSnapshot(now - std::chrono::duration_cast<Clock::duration>(behind));
+		}
+
+		std::this_thread::sleep_for(std::chrono::duration<double>((1.0f - clock.alpha()) * clock.step()));
+	}
+}
+
+void Scene::StopSimulationThread()
+{
+	if (!mSimulationThread.joinable())
+		return;
+
+	mStopSimulation = true;
+	mSimulationThread.join();
+}
+
+void Scene::PublishSnapshot(std::chrono::steady_clock::time_point time)
+{
+	SceneSnapshot& snapshot = mSnapshots.back();
+	const int buffer = mSnapshots.backIndex();
+
+	snapshot.WorldTransform.resize(mObjects.size());
+	snapshot.TexTransform.resize(mObjects.size());
+	snapshot.ChangedStep.resize(mObjects.size(), 0);
+	snapshot.SnappedStep.resize(mObjects.size(), 0);
+
+	// Each buffer has its own dirty list in mObjects.
+	for (ObjectTransforms::Handle handle : mObjects.getDirty(buffer))
+	{
+		snapshot.WorldTransform[handle] = mObjects.getWorld(handle);
+		snapshot.TexTransform[handle] = mObjects.getTexTransform(handle);
+		snapshot.ChangedStep[handle] = mFrameCount;
+		snapshot.SnappedStep[handle] = handle < mSnappedStep.size() ? mSnappedStep[handle] : 0;
+	}
+	mObjects.clearDirty(buffer);
+
+	if (snapshot.RenderItemsVersion != mRenderItemsVersion)
+	{
+		for (int i = 0; i < (int)RenderLayer::Count; ++i)
+		{
+			snapshot.RenderItems[i].clear();
+			for (const RenderItem* ri : mRitemLayer[i])
+				snapshot.RenderItems[i].push_back(*ri);
+		}
+		snapshot.RenderItemsVersion = mRenderItemsVersion;
+	}
+
+	snapshot.Step = mFrameCount;
+	snapshot.Time = time;
+	snapshot.StepLength = mSimulationStep;
+	mSnapshots.publish();
+}
+
+void Scene::ReceiveSnapshot()
+{
+	if (mSnapshots.acquire())
+	{
+		const SceneSnapshot& snapshot = mSnapshots.front();
+
+		// Objects that changed since the last snapshot drawn move from where
+		// that one left them.  Render side handles are never removed, so new
+		// ones are appended in order.
+		mRenderObjects.beginStep();
+		for (ObjectTransforms::Handle handle = 0; handle < (ObjectTransforms::Handle)snapshot.WorldTransform.size(); ++handle)
+		{
+			if (handle >= mRenderObjects.size())
+			{
+				mRenderObjects.add(XMLoadFloat4x4(&snapshot.WorldTransform[handle]), XMLoadFloat4x4(&snapshot.TexTransform[handle]));
+			}
+			else if (snapshot.ChangedStep[handle] > mRenderStep)
+			{
+				mRenderObjects.setWorld(handle, XMLoadFloat4x4(&snapshot.WorldTransform[handle]));
+				mRenderObjects.setTexTransform(handle, XMLoadFloat4x4(&snapshot.TexTransform[handle]));
+
+				// An object that jumped since the last snapshot drawn is not
+				// blended across the jump.
+				if (snapshot.SnappedStep[handle] > mRenderStep)
+					mRenderObjects.resetInterpolation(handle);
+			}
+		}
+		mRenderStep = snapshot.Step;
+
+		if (snapshot.RenderItemsVersion != mSnapshotItemsVersion)
+		{
+			for (int i = 0; i < (int)RenderLayer::Count; ++i)
+			{
+				mSnapshotItems[i] = snapshot.RenderItems[i];
+				mSnapshotLayers[i].clear();
+				for (RenderItem& ri : mSnapshotItems[i])
+					mSnapshotLayers[i].push_back(&ri);
+			}
+			mSnapshotItemsVersion = snapshot.RenderItemsVersion;
+		}
+	}
+
+	// The frame shows the scene one step behind the latest snapshot, so it
+	// can blend towards it.
+	const SceneSnapshot& snapshot = mSnapshots.front();
+	if (snapshot.StepLength > 0.0f)
+	{
+		std::chrono::duration<double> since = std::chrono::steady_clock::now() - snapshot.Time;
+		mRenderAlpha = MathHelper::Clamp((float)(since.count() / snapshot.StepLength), 0.0f, 1.0f);
+	}
+	else
+	{
+		mRenderAlpha = 1.0f;
+	}
+}
+
+ObjectTransforms& Scene::GetDrawObjects()
+{
+	return mSimulationThreadEnabled ? mRenderObjects : mObjects;
+}
+
+std::vector<RenderItem*>* Scene::GetDrawLayers()
+{
+	return mSimulationThreadEnabled ? mSnapshotLayers : mRitemLayer;
+}
+
+void Scene::BuildGroundGeometry()
+{
+	GeometryGenerator geoGen;
+	GeometryGenerator::MeshData ground = geoGen.CreateBox(20, 0.2, 20, 1);
+
+
+	std::vector<Vertex> vertices(ground.Vertices.size());
+	for (size_t i = 0; i < ground.Vertices.size(); ++i)
+	{
+		auto& p = ground.Vertices[i].Position;
+		vertices[i].Pos = p;
+		vertices[i].Normal = ground.Vertices[i].Normal;
+		vertices[i].TexC = ground.Vertices[i].TexC;
+	}
+
+	const std::uint32_t vbByteSize = (std::uint32_t)vertices.size() * sizeof(Vertex);
+
+	std::vector<std::uint16_t> indices = ground.GetIndices16();
+	const std::uint32_t ibByteSize = (std::uint32_t)indices.size() * sizeof(std::uint16_t);
+
+	Mesh mesh;
+	mesh.IndexCount = (std::uint32_t)indices.size();
+	mesh.StartIndexLocation = 0;
+	mesh.BaseVertexLocation = 0;
+	MeshHandle handle = mMeshTable.add("ground", mesh);
+
+	mRenderDevice->createMeshBuffers(handle, vertices.data(), vbByteSize, sizeof(Vertex), indices.data(), ibByteSize);
+}
+
+void Scene::BuildFrameResources()
+{
+	mRenderDevice->createFrameResources(mFramesInFlight, (std::uint32_t)mObjects.size(), (std::uint32_t)mMaterials.size());
+	mFrameScheduler.reset(mRenderDevice->fence(), mFramesInFlight);
+}
+
+void Scene::BuildMaterials()
+{
+	//GameWorld.buildMaterials(mMaterials);
+
+	int matIndex = 0;
+	auto BackgroundTex = std::make_unique<Material>();
+	BackgroundTex->Name = "BackgroundTex";
+	BackgroundTex->MatCBIndex = matIndex;
+	BackgroundTex->DiffuseSrvHeapIndex = matIndex++;
+	BackgroundTex->DiffuseAlbedo = XMFLOAT4(1.0f, 1.0f, 1.0f, 1.0f);
+	BackgroundTex->FresnelR0 = XMFLOAT3(0.01f, 0.01f, 0.01f);
+	BackgroundTex->Roughness = 0.125f;
+
+	
+
+	auto Eagle = std::make_unique<Material>();
+	Eagle->Name = "Eagle";
+	Eagle->MatCBIndex = matIndex;
+	Eagle->DiffuseSrvHeapIndex = matIndex++;
+	Eagle->DiffuseAlbedo = XMFLOAT4(1.0f, 1.0f, 1.0f, 1.0f);
+	Eagle->FresnelR0 = XMFLOAT3(0.02f, 0.02f, 0.02f);
+	Eagle->Roughness = 0.25f;
+
+	auto Raptor = std::make_unique<Material>();
+	Raptor->Name = "Raptor";
+	Raptor->MatCBIndex = matIndex;
+	Raptor->DiffuseSrvHeapIndex = matIndex++;
+	Raptor->DiffuseAlbedo = XMFLOAT4(1.0f, 1.0f, 1.0f, 1.0f);
+	Raptor->FresnelR0 = XMFLOAT3(0.01f, 0.01f, 0.01f);
+	Raptor->Roughness = 0.125f;
+
+	
+
+	// Registered in MatCBIndex order.
+	// New materials start out dirty in every frame resource.
+	mDirtyMaterials.push_back(mMaterialTable.add("BackgroundTex", BackgroundTex.get()));
+	mDirtyMaterials.push_back(mMaterialTable.add("EagleTex", Eagle.get()));
+	mDirtyMaterials.push_back(mMaterialTable.add("RaptorTex", Raptor.get()));
+	for (Material* mat : mMaterialTable)
+		mat->NumFramesDirty = mFramesInFlight;
+
+	mMaterials["BackgroundTex"] = std::move(BackgroundTex);
+	mMaterials["EagleTex"] = std::move(Eagle);
+	mMaterials["RaptorTex"] = std::move(Raptor);
+	
+
+}
+
+void Scene::BuildRenderItems()
+{
+	// Size the node storage up front so spawning during gameplay stays off the heap.
+	const std::size_t maxEntities = 1024;
+	mTransforms.reserve(LayerCount + 2 * maxEntities);
+	mObjects.reserve(2 * maxEntities);
+	mEntityPool.reserve(maxEntities);
+	mAircraftPool.reserve(maxEntities);
+	mDrawQueue.reserve(2 * maxEntities);
+
+	// Initialize the different layers
+	for (std::size_t i = 0; i < LayerCount; ++i)
+	{
+		SceneNode::Ptr layer = mNodePool.create(mTransforms);
+		layer->reserveChildren(maxEntities);
+		mSceneLayers[i] = layer.get();
+
+		mSceneGraph.attachChild(std::move(layer));
+	}
+
+	// Resolve the shared resources once for the whole batch.
+	MaterialHandle backgroundMat = mMaterialTable.find("BackgroundTex");
+	MaterialHandle eagleMat = mMaterialTable.find("EagleTex");
+	MaterialHandle raptorMat = mMaterialTable.find("RaptorTex");
+	MeshHandle ground = mMeshTable.find("ground");
+
+	SpawnDesc descs[5];
+
+	// Two scrolling background tiles, the second queued up behind the first.
+	for (int i = 0; i < 2; ++i)
+	{
+		SpawnDesc& desc = descs[i];
+		desc.Type = SpawnDesc::Scenery;
+		desc.SceneLayer = Background;
+		desc.DrawLayer = RenderLayer::Opaque;
+		desc.Mat = backgroundMat;
+		desc.Mesh = ground;
+		desc.Position = XMFLOAT3(0.0f, 0.0f, 12.0f * i);
+		desc.Velocity = XMFLOAT3(0.0f, 0.0f, -0.5f);
+		XMStoreFloat4x4(&desc.TexTransform, XMMatrixScaling(10.0f, 10.0f, 10.0f));
+	}
+
+	// The main plane and its two wingmen.
+	const XMFLOAT3 planePositions[3] = { { -1.0f, 1.0f, -1.0f }, { -1.25f, 1.0f, -1.25f }, { -0.75f, 1.0f, -1.25f } };
+	for (int i = 0; i < 3; ++i)
+	{
+		SpawnDesc& desc = descs[2 + i];
+		desc.Type = i == 0 ? SpawnDesc::Raptor : SpawnDesc::Eagle;
+		desc.SceneLayer = Air;
+		desc.DrawLayer = RenderLayer::AlphaTested;
+		desc.Mat = i == 0 ? raptorMat : eagleMat;
+		desc.Mesh = ground;
+		desc.Position = planePositions[i];
+		desc.Scale = XMFLOAT3(0.01f, 0.01f, 0.01f);/// can choose your scaling here
+		desc.Velocity = XMFLOAT3(0.5f, 0.0f, 0.0f);
+	}
+
+	std::vector<Entity*> spawned;
+	SpawnEntities(descs, sizeof(descs) / sizeof(descs[0]), spawned);
+
+	background = spawned[0];
+	background2 = spawned[1];
+	mPlane = static_cast<Aircraft*>(spawned[2]);
+	leftPlane = static_cast<Aircraft*>(spawned[3]);
+	rightPlane = static_cast<Aircraft*>(spawned[4]);
+}
+
+void Scene::SpawnEntities(const SpawnDesc* descs, std::size_t count, std::vector<Entity*>& spawned)
+{
+	// Size every container for the whole batch up front.
+	std::size_t aircraftCount = 0;
+	std::size_t layerCounts[LayerCount] = {};
+	std::size_t drawLayerCounts[(int)RenderLayer::Count] = {};
+	for (std::size_t i = 0; i < count; ++i)
+	{
+		if (descs[i].Type != SpawnDesc::Scenery)
+			++aircraftCount;
+		++layerCounts[descs[i].SceneLayer];
+		++drawLayerCounts[(int)descs[i].DrawLayer];
+	}
+
+	// Grow geometrically so a stream of small batches does not reallocate every time.
+	auto grown = [](std::size_t size, std::size_t extra) { return MathHelper::Max(size + extra, size + size / 2); };
+
+	mTransforms.reserve(grown(mTransforms.size(), count));
+	mObjects.reserve(grown(mObjects.size(), count));
+	mEntityPool.reserve(count - aircraftCount);
+	mAircraftPool.reserve(aircraftCount);
+	mAllRitems.reserve(grown(mAllRitems.size(), count));
+	spawned.reserve(spawned.size() + count);
+	for (int i = 0; i < LayerCount; ++i)
+		mSceneLayers[i]->reserveChildren(grown(mSceneLayers[i]->getChildCount(), layerCounts[i]));
+	for (int i = 0; i < (int)RenderLayer::Count; ++i)
+		mRitemLayer[i].reserve(grown(mRitemLayer[i].size(), drawLayerCounts[i]));
+
+	for (std::size_t i = 0; i < count; ++i)
+	{
+		const SpawnDesc& desc = descs[i];
+
+		SceneNode::Ptr node;
+		Entity* entity = nullptr;
+		if (desc.Type == SpawnDesc::Scenery)
+		{
+			auto created = mEntityPool.create(mTransforms);
+			entity = created.get();
+			node = std::move(created);
+		}
+		else
+		{
+			auto created = mAircraftPool.create(desc.Type == SpawnDesc::Raptor ? Aircraft::Raptor : Aircraft::Eagle, mTransforms);
+			entity = created.get();
+			node = std::move(created);
+		}
+
+		XMVECTOR position = XMLoadFloat3(&desc.Position);
+		XMVECTOR scale = XMLoadFloat3(&desc.Scale);
+		entity->setPosition(position);
+		entity->setScale(scale);
+		entity->setVelocity(XMLoadFloat3(&desc.Velocity));
+		entity->renderHandle = mObjects.add(XMMatrixScalingFromVector(scale) * XMMatrixTranslationFromVector(position),
+			XMLoadFloat4x4(&desc.TexTransform));
+
+		const Mesh& mesh = mMeshTable.get(desc.Mesh);
+
+		auto ritem = std::make_unique<RenderItem>();
+		ritem->ObjCBIndex = entity->renderHandle;
+		ritem->MaterialId = desc.Mat;
+		ritem->MeshId = desc.Mesh;
+		ritem->PrimitiveType = PrimitiveTopology::TriangleList;
+		ritem->IndexCount = mesh.IndexCount;
+		ritem->StartIndexLocation = mesh.StartIndexLocation;
+		ritem->BaseVertexLocation = mesh.BaseVertexLocation;
+
+		mRitemLayer[(int)desc.DrawLayer].push_back(ritem.get());
+		mAllRitems.push_back(std::move(ritem));
+
+		mSceneLayers[desc.SceneLayer]->attachChild(std::move(node));
+		spawned.push_back(entity);
+	}
+
+	++mRenderItemsVersion;
+}
+
+void Scene::QueueRenderItems(std::uint32_t pass, PsoHandle pso, bool backToFront, const std::vector<RenderItem*>& ritems)
+{
+	const ObjectTransforms& objects = GetDrawObjects();
+	XMMATRIX view = mCamera.GetView();
+	float nearZ = mMainPassCB.NearZ;
+	float depthRange = mMainPassCB.FarZ - mMainPassCB.NearZ;
+
+	for (size_t i = 0; i < ritems.size(); ++i)
+	{
+		auto ri = ritems[i];
+
+		// View space depth of the object's origin.
+		const XMFLOAT4X4& world = objects.getWorld(ri->ObjCBIndex);
+		XMVECTOR position = XMVector3TransformCoord(XMVectorSet(world._41, world._42, world._43, 1.0f), view);
+
+		DrawQueue::Packet packet;
+		packet.Pass = pass;
+		packet.BackToFront = backToFront;
+		packet.Pso = pso;
+		packet.Material = ri->MaterialId;
+		packet.Mesh = ri->MeshId;
+		packet.Topology = (std::uint32_t)ri->PrimitiveType;
+		packet.Depth = (XMVectorGetZ(position) - nearZ) / depthRange;
+		packet.ObjCBIndex = ri->ObjCBIndex;
+		packet.IndexCount = ri->IndexCount;
+		packet.StartIndexLocation = ri->StartIndexLocation;
+		packet.BaseVertexLocation = ri->BaseVertexLocation;
+
+		mDrawQueue.add(packet);
+	}
+}
@@ -0,0 +1,299 @@
+#pragma once
+
+#include "../../Common/MathHelper.h"
+#include "../../Common/Camera.h"
+#include "../../Common/ShadingData.h"
+#include "DrawQueue.h"
+#include "FrameArena.h"
+#include "FrameConstants.h"
+#include "FrameContext.h"
+#include "FrameScheduler.h"
+#include "ObjectTransforms.h"
+#include "RenderDevice.h"
+#include "ResourceRegistry.h"
+#include "SceneCommandQueue.h"
+#include "SceneNode.h"
+#include "ThreadPool.h"
+#include "TransformStore.h"
+#include "TripleBuffer.h"
+#include "Aircraft.h"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+using namespace DirectX;
+
+
+enum class RenderLayer : int
+{
+	Opaque = 0,
+	Transparent,
+	AlphaTested,
+	AlphaTestedTreeSprites,
+	Count
+};
+
+// The game's scene and the CPU side of every frame: the scene graph and its
+// simulation, the render items, the per-frame constant uploads and the draw
+// recording.  Everything meant for the GPU goes through a RenderDevice, so the
+// whole frame path builds and runs without D3D12 on a NullRenderDevice.  World
+// adds the window, the input and the D3D12 backend on top.
+class Scene
+{
+public:
+	// framesInFlight is how many frames the CPU may get ahead of the GPU; each
+	// gets its own frame resource.
+	explicit Scene(int framesInFlight = gNumFrameResources);
+	Scene(const Scene& rhs) = delete;
+	Scene& operator=(const Scene& rhs) = delete;
+	~Scene();
+
+	// Builds the meshes, materials, entities and frame resources on device,
+	// which must outlive the scene, and starts the simulation thread if one
+	// was asked for.
+	void Build(RenderDevice& device);
+
+	// Runs the scene simulation on a thread of its own, stepping every
+	// stepSeconds, instead of from Step.  Update and Draw show the latest
+	// state it published.  Call before Build.
+	void EnableSimulationThread(float stepSeconds);
+
+	// Sets the size of the render target and fits the camera lens to it.
+	void Resize(int width, int height);
+
+	// Advances the simulation by one fixed step.  Does nothing while the
+	// simulation thread runs.
+	void Step(float dt);
+
+	// Starts a frame: waits for the GPU to release the next frame resource and
+	// uploads whatever changed.  stepAlpha is how far the frame is between the
+	// last two simulation steps; ignored while the simulation thread runs.
+	void Update(float totalTime, float deltaTime, float stepAlpha);
+
+	// Sorts and records the draws of the frame Update started and submits it.
+	void Draw();
+
+	Camera& GetCamera();
+
+	// Queues the material's constants for upload to every frame resource.
+	// Call after changing any of its fields.
+	void MarkMaterialDirty(MaterialHandle handle);
+
+	// Resources the draws refer to by handle, for the backend to resolve.
+	const Material& GetMaterial(MaterialHandle handle) const;
+	const ResourceRegistry<RenderLayer, PsoHandle>& GetPsoTable() const;
+
+	// Runs the per-layer scene graph update jobs and the draw recording jobs.
+	// A backend needs one command list per thread.
+	ThreadPool& GetThreadPool();
+
+	// Binds issued and skipped by the last Draw.
+	const DrawQueue::Stats& GetDrawStats() const;
+	const FrameScheduler::Stats& GetFrameStats() const;
+
+	std::size_t GetRenderItemCount() const;
+
+	// FNV-1a hash of the world matrix of every render item, in creation
+	// order.  Runs that simulated the same thing give the same hash.  Not
+	// while the simulation thread runs.
+	std::uint64_t HashRenderItems() const;
+
+
+private:
+	enum Layer
+	{
+		Background,
+		Air,
+		LayerCount
+	};
+
+	// The part of a mesh one render item draws.  The vertex and index buffers
+	// belong to the RenderDevice.
+	struct Mesh
+	{
+		std::uint32_t IndexCount = 0;
+		std::uint32_t StartIndexLocation = 0;
+		std::int32_t BaseVertexLocation = 0;
+	};
+
+	// What the simulation thread hands the render thread after each batch of
+	// steps.  Every buffer holds the whole scene, but only what changed since
+	// the buffer was last published is copied into it.
+	struct SceneSnapshot
+	{
+		std::uint64_t Step = 0;
+		std::chrono::steady_clock::time_point Time;
+		float StepLength = 0.0f;
+
+		// Indexed by ObjectTransforms handle.  ChangedStep is the Step of the
+		// snapshot an object's matrices were last copied into.
+		std::vector<XMFLOAT4X4> WorldTransform;
+		std::vector<XMFLOAT4X4> TexTransform;
+		std::vector<std::uint64_t> ChangedStep;
+
+		// The last Step an object jumped in.  Frames are not blended across it.
+		std::vector<std::uint64_t> SnappedStep;
+
+		std::uint64_t RenderItemsVersion = 0;
+		std::vector<RenderItem> RenderItems[(int)RenderLayer::Count];
+	};
+
+	// Everything needed to put one entity in the world.  Material and mesh are
+	// looked up by the caller once per batch, not once per entity.
+	struct SpawnDesc
+	{
+		enum Kind
+		{
+			Scenery,
+			Eagle,
+			Raptor,
+		};
+
+		Kind Type = Scenery;
+		Layer SceneLayer = Background;
+		RenderLayer DrawLayer = RenderLayer::Opaque;
+
+		MaterialHandle Mat;
+		MeshHandle Mesh;
+
+		XMFLOAT3 Position = { 0.0f, 0.0f, 0.0f };
+		XMFLOAT3 Scale = { 1.0f, 1.0f, 1.0f };
+		XMFLOAT3 Velocity = { 0.0f, 0.0f, 0.0f };
+		XMFLOAT4X4 TexTransform = MathHelper::Identity4x4();
+	};
+
+
+private:
+	void BuildGroundGeometry();
+	void BuildMaterials();
+	void BuildRenderItems();
+	void BuildFrameResources();
+
+	// Creates one entity and render item per descriptor.  All storage is sized
+	// for the whole batch before the first entity is made.  The new entities
+	// are appended to spawned in descriptor order.
+	void SpawnEntities(const SpawnDesc* descs, std::size_t count, std::vector<Entity*>& spawned);
+
+	void Simulate(float dt);
+	void UpdateGameObjects(const FrameContext& frame);
+	void ApplySceneCommands();
+
+	// Draws the object where it is now in frames before the next step, instead
+	// of blending it from where it was, and tells the render thread to as well.
+	void SnapObject(ObjectTransforms::Handle handle);
+	void RemoveRenderItems(const std::vector<ObjectTransforms::Handle>& handles);
+
+	void UpdateObjectCBs();
+	void UpdateMaterialCBs();
+	void UpdateMainPassCB(float totalTime, float deltaTime);
+	void QueueRenderItems(std::uint32_t pass, PsoHandle pso, bool backToFront, const std::vector<RenderItem*>& ritems);
+
+	void SimulationLoop();
+	void StopSimulationThread();
+	void PublishSnapshot(std::chrono::steady_clock::time_point time);
+	void ReceiveSnapshot();
+
+	// The transforms and render items the render thread draws from.
+	ObjectTransforms& GetDrawObjects();
+	std::vector<RenderItem*>* GetDrawLayers();
+
+
+private:
+	// Every upload and submission of the frame path goes through this.
+	RenderDevice* mRenderDevice = nullptr;
+
+	// Picks the frame resource each frame goes to and waits for the GPU to
+	// release it.
+	int mFramesInFlight;
+	FrameScheduler mFrameScheduler;
+	int mCurrFrameResourceIndex = 0;
+
+	int mRenderTargetWidth = 800;
+	int mRenderTargetHeight = 600;
+
+	std::unordered_map<std::string, std::unique_ptr<Material>> mMaterials;
+
+	// Names are interned into these once at load time; the draw and update
+	// paths index them by handle.  Each pipeline records the layer it draws.
+	ResourceRegistry<RenderLayer, PsoHandle>			mPsoTable;
+	ResourceRegistry<Material*, MaterialHandle>			mMaterialTable;
+	ResourceRegistry<Mesh, MeshHandle>					mMeshTable;
+
+	// Materials some frame resource still holds a stale copy of.
+	std::vector<MaterialHandle>	mDirtyMaterials;
+
+	PsoHandle	mOpaquePso;
+	PsoHandle	mTransparentPso;
+	PsoHandle	mAlphaTestedPso;
+
+	// Rebuilt and sorted every frame.
+	DrawQueue			mDrawQueue;
+	DrawQueue::Stats	mDrawStats;
+
+	// List of all the render items.
+	std::vector<std::unique_ptr<RenderItem>> mAllRitems;
+
+	// World/TexTransform of every render item, indexed by ObjCBIndex.
+	ObjectTransforms mObjects;
+
+	// Bumped whenever render items are added or removed.
+	std::uint64_t mRenderItemsVersion = 0;
+
+	// Render items divided by PSO.
+	std::vector<RenderItem*> mRitemLayer[(int)RenderLayer::Count];
+
+	PassConstants mMainPassCB;
+	Camera mCamera;
+
+	// Must outlive every scene node, so these are declared ahead of them.
+	TransformStore						mTransforms;
+	NodePool<SceneNode>					mNodePool;
+	NodePool<Entity>					mEntityPool;
+	NodePool<Aircraft>					mAircraftPool;
+	SceneNode							mSceneGraph;
+	std::array<SceneNode*, LayerCount>	mSceneLayers;
+
+	Aircraft* mPlane;
+	Aircraft* leftPlane;
+	Aircraft* rightPlane;
+	Entity* background;
+	Entity* background2;
+
+	ThreadPool	mUpdatePool;
+
+	// Scene graph changes requested during the update, applied once it is done.
+	SceneCommandQueue	mSceneCommands;
+	std::vector<ObjectTransforms::Handle>	mReleasedObjects;
+
+	// Per-step scratch memory handed to the update path through FrameContext.
+	FrameArena		mFrameArena;
+	std::uint64_t	mFrameCount = 0;
+
+	// The step each object last jumped in, indexed by handle, for the snapshots.
+	std::vector<std::uint64_t>	mSnappedStep;
+	double			mSimulationTime = 0.0;
+
+	// How far the frame being drawn is between the last two simulation steps.
+	float			mRenderAlpha = 1.0f;
+
+	// Optional simulation thread.  It owns the scene graph, mObjects and
+	// mRitemLayer while it runs; the render thread only reads its snapshots,
+	// mirrored into mRenderObjects and mSnapshotLayers.
+	bool								mSimulationThreadEnabled = false;
+	float								mSimulationStep = 0.0f;
+	std::thread							mSimulationThread;
+	std::atomic<bool>					mStopSimulation;
+	std::unique_ptr<ThreadPool>			mSimulationPool;
+	TripleBuffer<SceneSnapshot>			mSnapshots;
+
+	ObjectTransforms					mRenderObjects;
+	std::vector<RenderItem>				mSnapshotItems[(int)RenderLayer::Count];
+	std::vector<RenderItem*>			mSnapshotLayers[(int)RenderLayer::Count];
+	std::uint64_t						mRenderStep = 0;
+	std::uint64_t						mSnapshotItemsVersion = 0;
+};
@@ -0,0 +1,80 @@
+#include "SceneCommandQueue.h"
+#include <algorithm>
+#include <functional>
+
+
+void SceneCommandQueue::spawn(SceneNode& parent, SceneNode::Ptr node)
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+	mSpawns.push_back({ &parent, std::move(node) });
+}
+
+void SceneCommandQueue::destroy(SceneNode& node)
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+	mDestroys.push_back(&node);
+}
+
+void SceneCommandQueue::reparent(SceneNode& node, SceneNode& newParent)
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+	mReparents.push_back({ &node, &newParent });
+}
+
+bool SceneCommandQueue::empty() const
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+	return mSpawns.empty() && mReparents.empty() && mDestroys.empty();
+}
+
+void SceneCommandQueue::apply(std::vector<ObjectTransforms::Handle>* releasedRenderHandles)
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+
+	// Group spawns by parent so each child list grows at most once.
+	std::stable_sort(mSpawns.begin(), mSpawns.end(),
+		[](const Spawn& a, const Spawn& b) { return std::less<SceneNode*>()(a.parent, b.parent); });
+
+	for (std::size_t first = 0; first < mSpawns.size();)
+	{
+		SceneNode* parent = mSpawns[first].parent;
+		std::size_t last = first;
+		while (last < mSpawns.size() && mSpawns[last].parent == parent)
+			++last;
+
+		parent->reserveChildren(parent->getChildCount() + (last - first));
+		for (std::size_t i = first; i < last; ++i)
+			parent->attachChild(std::move(mSpawns[i].node));
+
+		first = last;
+	}
+	mSpawns.clear();
+
+	for (const Reparent& move : mReparents)
+	{
+		SceneNode* oldParent = move.node->getParent();
+		if (oldParent == move.newParent)
+			continue;
+
+		SceneNode::Ptr node = oldParent->detachChild(*move.node);
+		move.newParent->attachChild(std::move(node));
+	}
+	mReparents.clear();
+
+	if (!mDestroys.empty())
+	{
+		if (releasedRenderHandles != nullptr)
+		{
+			for (SceneNode* node : mDestroys)
+				node->collectRenderHandles(*releasedRenderHandles);
+
+			// A node listed together with one of its ancestors is reported twice.
+			std::sort(releasedRenderHandles->begin(), releasedRenderHandles->end());
+			releasedRenderHandles->erase(std::unique(releasedRenderHandles->begin(), releasedRenderHandles->end()),
+				releasedRenderHandles->end());
+		}
+
+		SceneNode::detachChildren(mDestroys);
+		mDestroys.clear();
+	}
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include "SceneNode.h"
+#include <mutex>
+#include <vector>
+
+// Collects scene graph mutations requested while the graph is being updated and
+// applies them in one batch at a sync point, once no update job is iterating
+// any child list.  Requests may be queued from any update job.
+class SceneCommandQueue
+{
+public:
+	SceneCommandQueue() = default;
+	SceneCommandQueue(const SceneCommandQueue& rhs) = delete;
+	SceneCommandQueue& operator=(const SceneCommandQueue& rhs) = delete;
+
+	void					spawn(SceneNode& parent, SceneNode::Ptr node);
+	void					destroy(SceneNode& node);
+	void					reparent(SceneNode& node, SceneNode& newParent);
+
+	bool					empty() const;
+
+	// Applies spawns first, grouped by parent, then reparents, then destroys, so
+	// destroying a node spawned or moved in the same frame still wins.  The
+	// render handles of every destroyed node and its descendants are appended
+	// to releasedRenderHandles when given.
+	void					apply(std::vector<ObjectTransforms::Handle>* releasedRenderHandles = nullptr);
+
+
+private:
+	struct Spawn
+	{
+		SceneNode*			parent;
+		SceneNode::Ptr		node;
+	};
+
+	struct Reparent
+	{
+		SceneNode*			node;
+		SceneNode*			newParent;
+	};
+
+
+private:
+	mutable std::mutex			mMutex;
+	std::vector<Spawn>			mSpawns;
+	std::vector<Reparent>		mReparents;
+	std::vector<SceneNode*>		mDestroys;
+};
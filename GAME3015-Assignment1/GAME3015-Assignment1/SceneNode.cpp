@@ -3,80 +3,250 @@
 #include <cassert>
 
 
-SceneNode::SceneNode()
-	: mChildren()
+void SceneNodeDeleter::operator()(SceneNode* node) const
+{
+	if (node->mPool != nullptr)
+		node->mPool->release(node);
+	else
+		delete node;
+}
+
+std::atomic<bool> SceneNode::sUpdating(false);
+
+SceneNode::SceneNode(TransformStore& transforms)
+	: renderHandle(ObjectTransforms::InvalidHandle)
+	, mChildren()
 	, mParent(nullptr)
+	, mIndexInParent(0)
+	, mDetachMarked(false)
+	, mCompactPending(false)
+	, mPool(nullptr)
+	, mTransforms(&transforms)
+	, mTransform(transforms.create())
 {
 }
 
+SceneNode::~SceneNode()
+{
+	// Release the children's transforms first so ours is never freed while
+	// something still refers to it as a parent.
+	mChildren.clear();
+	mTransforms->destroy(mTransform);
+}
+
 void SceneNode::attachChild(Ptr child)
 {
+	assert(!sUpdating);
+
 	child->mParent = this;
+	child->mIndexInParent = mChildren.size();
+	mTransforms->setParent(child->mTransform, mTransform);
 	mChildren.push_back(std::move(child));
 }
 
 SceneNode::Ptr SceneNode::detachChild(const SceneNode& node)
 {
-	auto found = std::find_if(mChildren.begin(), mChildren.end(), [&](Ptr& p) { return p.get() == &node; });
-	assert(found != mChildren.end());
+	assert(!sUpdating);
+	assert(node.mParent == this);
+
+	std::size_t index = node.mIndexInParent;
+	Ptr result = std::move(mChildren[index]);
+
+	// Swap-and-pop: fill the hole with the last sibling.
+	if (index + 1 != mChildren.size())
+	{
+		mChildren[index] = std::move(mChildren.back());
+		mChildren[index]->mIndexInParent = index;
+	}
+	mChildren.pop_back();
 
-	Ptr result = std::move(*found);
 	result->mParent = nullptr;
-	mChildren.erase(found);
+	mTransforms->setParent(result->mTransform, TransformStore::InvalidHandle);
 	return result;
 }
 
-void SceneNode::update(GameTimer dt , std::vector<std::unique_ptr<RenderItem>>& renderList)
+void SceneNode::detachChildren(const std::vector<SceneNode*>& nodes, std::vector<Ptr>* removed)
+{
+	assert(!sUpdating);
+
+	// Mark the nodes and collect each affected parent once.
+	std::vector<SceneNode*> parents;
+	for (SceneNode* node : nodes)
+	{
+		assert(node->mParent != nullptr);
+		if (node->mDetachMarked)
+			continue;
+
+		node->mDetachMarked = true;
+		if (!node->mParent->mCompactPending)
+		{
+			node->mParent->mCompactPending = true;
+			parents.push_back(node->mParent);
+		}
+	}
+
+	// Nothing is destroyed until every parent is compacted, so a listed node may
+	// safely be the parent of another listed node.
+	std::vector<Ptr> detached;
+	std::vector<Ptr>& out = removed != nullptr ? *removed : detached;
+	for (SceneNode* parent : parents)
+		parent->compactChildren(out);
+}
+
+void SceneNode::compactChildren(std::vector<Ptr>& removed)
+{
+	std::size_t write = 0;
+	for (std::size_t read = 0; read < mChildren.size(); ++read)
+	{
+		Ptr& child = mChildren[read];
+		if (child->mDetachMarked)
+		{
+			child->mDetachMarked = false;
+			child->mParent = nullptr;
+			mTransforms->setParent(child->mTransform, TransformStore::InvalidHandle);
+			removed.push_back(std::move(child));
+		}
+		else
+		{
+			if (write != read)
+				mChildren[write] = std::move(child);
+			mChildren[write]->mIndexInParent = write;
+			++write;
+		}
+	}
+
+	mChildren.erase(mChildren.begin() + write, mChildren.end());
+	mCompactPending = false;
+}
+
+void SceneNode::reserveChildren(std::size_t count)
+{
+	mChildren.reserve(count);
+}
+
+SceneNode* SceneNode::getParent() const
 {
-	updateCurrent(dt, renderList);
-	updateChildren(dt, renderList);
+	return mParent;
 }
 
-void SceneNode::updateCurrent(GameTimer  dt, std::vector<std::unique_ptr<RenderItem>>& renderList)
+std::size_t SceneNode::getChildCount() const
+{
+	return mChildren.size();
+}
+
+void SceneNode::collectRenderHandles(std::vector<ObjectTransforms::Handle>& handles) const
+{
+	if (renderHandle != ObjectTransforms::InvalidHandle)
+		handles.push_back(renderHandle);
+
+	for (const Ptr& child : mChildren)
+		child->collectRenderHandles(handles);
+}
+
+void SceneNode::beginUpdate()
+{
+	sUpdating = true;
+}
+
+void SceneNode::endUpdate()
+{
+	sUpdating = false;
+}
+
+void SceneNode::update(const FrameContext& frame, ObjectTransforms& objects)
+{
+	updateCurrent(frame, objects);
+	updateChildren(frame, objects);
+}
+
+void SceneNode::updateParallel(const FrameContext& frame, ObjectTransforms& objects, ThreadPool& pool, int splitDepth)
+{
+	updateCurrent(frame, objects);
+
+	if (splitDepth <= 0)
+	{
+		updateChildren(frame, objects);
+		return;
+	}
+
+	// Batch small siblings together so a layer with thousands of children
+	// does not pay for a job per child.
+	const std::size_t batchSize = 64;
+	for (std::size_t first = 0; first < mChildren.size(); first += batchSize)
+	{
+		std::size_t last = std::min(first + batchSize, mChildren.size());
+		pool.submit([this, &frame, &objects, &pool, splitDepth, first, last]()
+		{
+			for (std::size_t i = first; i < last; ++i)
+				mChildren[i]->updateParallel(frame, objects, pool, splitDepth - 1);
+		});
+	}
+}
+
+void SceneNode::updateCurrent(const FrameContext& frame, ObjectTransforms& objects)
 {
 	// Do nothing by default
 }
 
-void SceneNode::updateChildren(GameTimer dt, std::vector<std::unique_ptr<RenderItem>>& renderList)
+void SceneNode::updateChildren(const FrameContext& frame, ObjectTransforms& objects)
 {
 	for (Ptr& child : mChildren)
 	{
-		child->update(dt, renderList);
+		child->update(frame, objects);
 	}
 }
 
-void SceneNode::draw(ID3D12GraphicsCommandList* cmdList, RenderItem& ritems) 
+void SceneNode::setPosition(FXMVECTOR position)
 {
-	//// Apply transform of current node
-	//ritems.transform *= getTransform();
+	mTransforms->setPosition(mTransform, position);
+}
 
-	//// Draw node and children with changed transform
-	//drawCurrent(cmdList, ritems);
-	//drawChildren(cmdList, ritems);
+void SceneNode::setRotation(FXMVECTOR rotation)
+{
+	mTransforms->setRotation(mTransform, rotation);
 }
 
-void SceneNode::drawCurrent(ID3D12GraphicsCommandList* cmdList, RenderItem& ritems) 
+void SceneNode::setScale(FXMVECTOR scale)
 {
-	// Do nothing by default
+	mTransforms->setScale(mTransform, scale);
 }
 
-void SceneNode::drawChildren(ID3D12GraphicsCommandList* cmdList, RenderItem& ritems) 
+void SceneNode::move(FXMVECTOR offset)
 {
-	/*for (const Ptr& child : mChildren)
-		child->draw(cmdList, ritems);*/
+	mTransforms->move(mTransform, offset);
 }
 
-XMVECTOR SceneNode::getWorldPosition() const
+XMVECTOR SceneNode::getPosition() const
 {
-	return getWorldTransform() ;
+	return mTransforms->getPosition(mTransform);
 }
 
-XMVECTOR SceneNode::getWorldTransform() const
+XMVECTOR SceneNode::getRotation() const
 {
-	XMVECTOR transform = {0.0,0.0,0.0};
+	return mTransforms->getRotation(mTransform);
+}
 
-	for (const SceneNode* node = this; node != nullptr; node = node->mParent)
-		transform = node->mPosition + transform;
+XMVECTOR SceneNode::getScale() const
+{
+	return mTransforms->getScale(mTransform);
+}
+
+XMMATRIX SceneNode::getTransform() const
+{
+	return XMMatrixScalingFromVector(getScale()) * XMMatrixRotationQuaternion(getRotation()) * XMMatrixTranslationFromVector(getPosition());
+}
 
-	return transform;
+XMVECTOR SceneNode::getWorldPosition() const
+{
+	return getWorldTransform().r[3];
+}
+
+XMMATRIX SceneNode::getWorldTransform() const
+{
+	return mTransforms->getWorldTransform(mTransform);
+}
+
+TransformStore::Handle SceneNode::getTransformHandle() const
+{
+	return mTransform;
 }
@@ -1,21 +1,23 @@
 #pragma once
 
-#include "../../Common/d3dApp.h"
 #include "../../Common/MathHelper.h"
+#include "DrawCommandList.h"
+#include "FrameContext.h"
+#include "NodePool.h"
+#include "ObjectTransforms.h"
+#include "ResourceRegistry.h"
+#include "ThreadPool.h"
+#include "TransformStore.h"
 //#include "../../Common/UploadBuffer.h"
 //#include "../../Common/GeometryGenerator.h"
 //#include "../../Common/Camera.h"
 //#include "FrameResource.h"
 //#include "Waves.h"
 //#include <ctime>
+#include <atomic>
 #include <vector>
 
-using Microsoft::WRL::ComPtr;
 using namespace DirectX;
-using namespace DirectX::PackedVector;
-
-#pragma comment(lib, "d3dcompiler.lib")
-#pragma comment(lib, "D3D12.lib")
 
 // Lightweight structure stores parameters to draw a shape.  This will
 // vary from app-to-app.
@@ -23,69 +25,121 @@ struct RenderItem
 {
 	RenderItem() = default;
 
-	// World matrix of the shape that describes the object's local space
-	// relative to the world space, which defines the position, orientation,
-	// and scale of the object in the world.
-	XMFLOAT4X4 World = MathHelper::Identity4x4();
-
-	XMFLOAT4X4 TexTransform = MathHelper::Identity4x4();
-
-	// Dirty flag indicating the object data has changed and we need to update the constant buffer.
-	// Because we have an object cbuffer for each FrameResource, we have to apply the
-	// update to each FrameResource.  Thus, when we modify obect data we should set 
-	// NumFramesDirty = gNumFrameResources so that each frame resource gets the update.
-	int NumFramesDirty = gNumFrameResources;
-
-	// Index into GPU constant buffer corresponding to the ObjectCB for this render item.
-	UINT ObjCBIndex = -1;
+	// Index into the frame resource's ObjectData buffer for this render item.
+	// This is also the item's handle into ObjectTransforms, which holds its World and
+	// TexTransform matrices and tracks which frame resources need them re-uploaded.
+	std::uint32_t ObjCBIndex = ObjectTransforms::InvalidHandle;
 
-	Material* Mat = nullptr;
-	MeshGeometry* Geo = nullptr;
+	// Material and mesh handles, also used to build draw sort keys.
+	MaterialHandle MaterialId;
+	MeshHandle MeshId;
 
 	// Primitive topology.
-	D3D12_PRIMITIVE_TOPOLOGY PrimitiveType = D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST;
+	PrimitiveTopology PrimitiveType = PrimitiveTopology::TriangleList;
 
 	// DrawIndexedInstanced parameters.
-	UINT IndexCount = 0;
-	UINT StartIndexLocation = 0;
-	int BaseVertexLocation = 0;
+	std::uint32_t IndexCount = 0;
+	std::uint32_t StartIndexLocation = 0;
+	std::int32_t BaseVertexLocation = 0;
 };
 
 class SceneNode 
 {
+	template<typename T>
+	friend class NodePool;
+	friend struct SceneNodeDeleter;
+
 public:
-	typedef std::unique_ptr<SceneNode> Ptr;
+	typedef std::unique_ptr<SceneNode, SceneNodeDeleter> Ptr;
 
 
 public:
-	SceneNode();
+	explicit SceneNode(TransformStore& transforms);
+	virtual ~SceneNode();
 
 	void					attachChild(Ptr child);
-	Ptr						detachChild(const SceneNode& node);
 
-	void					update(GameTimer dt, std::vector<std::unique_ptr<RenderItem>>& renderList);
+	// Constant time: the last child is moved into the freed position, so the
+	// order of the remaining siblings is not preserved.
+	Ptr						detachChild(const SceneNode& node);
 
+	// Detaches every listed node from its parent with one compaction pass per
+	// affected parent, keeping the order of the remaining siblings.  Detached
+	// nodes are appended to removed when given, otherwise they are destroyed
+	// once every parent has been compacted.
+	static void				detachChildren(const std::vector<SceneNode*>& nodes, std::vector<Ptr>* removed = nullptr);
+
+	// Pre-sizes the child list so attaching up to count children during
+	// gameplay does not allocate.
+	void					reserveChildren(std::size_t count);
+
+	SceneNode*				getParent() const;
+	std::size_t				getChildCount() const;
+
+	// Appends the render handle of this node and every descendant that draws.
+	void					collectRenderHandles(std::vector<ObjectTransforms::Handle>& handles) const;
+
+	// Brackets a graph update.  Attaching or detaching in between trips an
+	// assert; queue the change on a SceneCommandQueue instead.
+	static void				beginUpdate();
+	static void				endUpdate();
+
+	void					update(const FrameContext& frame, ObjectTransforms& objects);
+
+	// Updates this node, then hands its children to the pool as jobs so that
+	// sibling subtrees run concurrently.  Children are split again down to
+	// splitDepth levels; below that each subtree is updated serially.  A node is
+	// always updated before any job for its children is submitted.  The caller
+	// must keep frame alive and wait() on the pool before reading the results.
+	void					updateParallel(const FrameContext& frame, ObjectTransforms& objects, ThreadPool& pool, int splitDepth);
+
+	// Local transform relative to the parent node.  The node only holds a handle;
+	// the values live in the shared TransformStore.
+	void					setPosition(FXMVECTOR position);
+	void					setRotation(FXMVECTOR rotation);
+	void					setScale(FXMVECTOR scale);
+	void					move(FXMVECTOR offset);
+
+	XMVECTOR				getPosition() const;
+	XMVECTOR				getRotation() const;
+	XMVECTOR				getScale() const;
+	XMMATRIX				getTransform() const;
+
+	// World transform as of the last TransformStore::updateWorldTransforms sweep.
 	XMVECTOR			getWorldPosition() const;
-	XMVECTOR			getWorldTransform() const;
+	XMMATRIX			getWorldTransform() const;
 
-	std::unique_ptr<RenderItem> renderItem;
-	int renderIndex;
+	TransformStore::Handle	getTransformHandle() const;
 
-	XMVECTOR mPosition;
-	XMVECTOR Scale;
+	// Handle of the render item's packed transform, or InvalidHandle if the node
+	// draws nothing.
+	ObjectTransforms::Handle renderHandle;
 
 private:
-	virtual void			updateCurrent(GameTimer dt, std::vector<std::unique_ptr<RenderItem>>& renderList);
-	void					updateChildren(GameTimer dt, std::vector<std::unique_ptr<RenderItem>>& renderList);
+	virtual void			updateCurrent(const FrameContext& frame, ObjectTransforms& objects);
+	void					updateChildren(const FrameContext& frame, ObjectTransforms& objects);
 
-	virtual void			draw(ID3D12GraphicsCommandList* cmdList, RenderItem& ritems) ;
-	virtual void			drawCurrent(ID3D12GraphicsCommandList* cmdList, RenderItem& ritems) ;
-	void					drawChildren(ID3D12GraphicsCommandList* cmdList, RenderItem& ritems) ;
+	void					compactChildren(std::vector<Ptr>& removed);
 
 
 private:
 	std::vector<Ptr>		mChildren;
 	SceneNode* mParent;
+
+	// Position of this node in mParent->mChildren.
+	std::size_t mIndexInParent;
+
+	// Bookkeeping for detachChildren.
+	bool mDetachMarked;
+	bool mCompactPending;
+
+	static std::atomic<bool> sUpdating;
+
+	// Pool this node was created from, or nullptr if it was created with new.
+	NodePoolBase* mPool;
+
+protected:
+	TransformStore* mTransforms;
+	TransformStore::Handle mTransform;
 	
 };
-
@@ -0,0 +1,49 @@
+#include "SimulatedFence.h"
+#include <cassert>
+
+
+SimulatedFence::SimulatedFence(unsigned latency)
+	: mLatency(latency)
+	, mSignalled(0)
+	, mCompleted(0)
+	, mWaits(0)
+{
+}
+
+std::uint64_t SimulatedFence::completedValue() const
+{
+	return mCompleted;
+}
+
+void SimulatedFence::wait(int slot, std::uint64_t value)
+{
+	assert(value <= mSignalled);
+
+	++mWaits;
+	complete(value);
+}
+
+std::uint64_t SimulatedFence::signal()
+{
+	++mSignalled;
+	if (mSignalled > mLatency)
+		complete(mSignalled - mLatency);
+
+	return mSignalled;
+}
+
+void SimulatedFence::complete(std::uint64_t value)
+{
+	if (value > mCompleted)
+		mCompleted = value;
+}
+
+void SimulatedFence::setLatency(unsigned latency)
+{
+	mLatency = latency;
+}
+
+std::uint64_t SimulatedFence::getWaitCount() const
+{
+	return mWaits;
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include "FrameFence.h"
+
+// FrameFence for a pretend GPU that stays a fixed number of frames behind the
+// CPU.  Waiting completes the awaited value at once and is counted, so frame
+// pacing can be exercised and checked without a device.
+class SimulatedFence : public FrameFence
+{
+public:
+	// latency is how many signalled values are still in flight after each signal.
+	explicit				SimulatedFence(unsigned latency);
+
+	virtual std::uint64_t	completedValue() const override;
+	virtual void			wait(int slot, std::uint64_t value) override;
+	virtual std::uint64_t	signal() override;
+
+	// Lets the GPU catch up to value, as if it had finished early.
+	void					complete(std::uint64_t value);
+
+	void					setLatency(unsigned latency);
+	std::uint64_t			getWaitCount() const;
+
+
+private:
+	unsigned				mLatency;
+	std::uint64_t			mSignalled;
+	std::uint64_t			mCompleted;
+	std::uint64_t			mWaits;
+};
@@ -0,0 +1,162 @@
+#include "ThreadPool.h"
+#include <cassert>
+#include <utility>
+
+
+namespace
+{
+	// Which pool and queue the current thread is working for, if any.
+	thread_local const ThreadPool* tOwner = nullptr;
+	thread_local unsigned tQueueIndex = 0;
+}
+
+ThreadPool::ThreadPool(unsigned threadCount)
+	: mQueued(0)
+	, mPending(0)
+	, mNextQueue(0)
+	, mStop(false)
+{
+	if (threadCount == 0)
+		threadCount = std::thread::hardware_concurrency();
+	if (threadCount == 0)
+		threadCount = 1;
+
+	for (unsigned i = 0; i < threadCount; ++i)
+		mQueues.push_back(std::make_unique<Queue>());
+
+	// Queue 0 belongs to whichever thread calls wait().
+	for (unsigned i = 1; i < threadCount; ++i)
+		mThreads.emplace_back(&ThreadPool::workerLoop, this, i);
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(mWakeMutex);
+		mStop = true;
+	}
+	mWake.notify_all();
+
+	for (std::thread& thread : mThreads)
+		thread.join();
+}
+
+unsigned ThreadPool::threadCount() const
+{
+	return (unsigned)mQueues.size();
+}
+
+void ThreadPool::submit(Job job)
+{
+	unsigned index = tOwner == this ? tQueueIndex : mNextQueue++ % (unsigned)mQueues.size();
+
+	// Count the job before it becomes visible so wait() can never see the
+	// pending count drop to zero while it is still queued.
+	mPending++;
+	try
+	{
+		std::lock_guard<std::mutex> lock(mQueues[index]->mutex);
+		mQueues[index]->jobs.push_back(std::move(job));
+	}
+	catch (...)
+	{
+		mPending--;
+		throw;
+	}
+	mQueued++;
+
+	{
+		std::lock_guard<std::mutex> lock(mWakeMutex);
+	}
+	mWake.notify_one();
+}
+
+void ThreadPool::wait()
+{
+	assert(tOwner != this);
+
+	tOwner = this;
+	tQueueIndex = 0;
+
+	while (mPending.load() > 0)
+	{
+		if (!tryRunOne(0))
+			std::this_thread::yield();
+	}
+
+	tOwner = nullptr;
+
+	std::exception_ptr error;
+	{
+		std::lock_guard<std::mutex> lock(mErrorMutex);
+		std::swap(error, mError);
+	}
+	if (error)
+		std::rethrow_exception(error);
+}
+
+void ThreadPool::workerLoop(unsigned index)
+{
+	tOwner = this;
+	tQueueIndex = index;
+
+	for (;;)
+	{
+		if (tryRunOne(index))
+			continue;
+
+		std::unique_lock<std::mutex> lock(mWakeMutex);
+		mWake.wait(lock, [this]() { return mStop || mQueued.load() > 0; });
+		if (mStop)
+			return;
+	}
+}
+
+bool ThreadPool::tryRunOne(unsigned index)
+{
+	Job job;
+	const unsigned count = (unsigned)mQueues.size();
+
+	// Newest job from our own queue first; it is the most likely to be warm in cache.
+	{
+		Queue& own = *mQueues[index];
+		std::lock_guard<std::mutex> lock(own.mutex);
+		if (!own.jobs.empty())
+		{
+			job = std::move(own.jobs.back());
+			own.jobs.pop_back();
+		}
+	}
+
+	// Otherwise steal the oldest job from another queue.
+	for (unsigned i = 1; !job && i < count; ++i)
+	{
+		Queue& victim = *mQueues[(index + i) % count];
+		std::lock_guard<std::mutex> lock(victim.mutex);
+		if (!victim.jobs.empty())
+		{
+			job = std::move(victim.jobs.front());
+			victim.jobs.pop_front();
+		}
+	}
+
+	if (!job)
+		return false;
+
+	mQueued--;
+
+	// A throwing job still counts as finished, or wait() would never return.
+	// Only the first exception is kept; wait() rethrows it.
+	try
+	{
+		job();
+	}
+	catch (...)
+	{
+		std::lock_guard<std::mutex> lock(mErrorMutex);
+		if (!mError)
+			mError = std::current_exception();
+	}
+	mPending--;
+	return true;
+}
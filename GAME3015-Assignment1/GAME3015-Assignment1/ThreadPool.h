@@ -0,0 +1,70 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Small work-stealing job pool built on std::thread.  Every thread owns a job
+// queue: it pushes and pops its own work at the back and steals from the front
+// of the other queues when it runs dry.  The thread that calls wait() takes
+// part in the work using queue 0, so a pool of one thread spawns no workers and
+// runs everything inline.
+class ThreadPool
+{
+public:
+	typedef std::function<void()> Job;
+
+
+public:
+	// A thread count of 0 uses std::thread::hardware_concurrency().
+	explicit ThreadPool(unsigned threadCount = 0);
+	ThreadPool(const ThreadPool& rhs) = delete;
+	ThreadPool& operator=(const ThreadPool& rhs) = delete;
+	~ThreadPool();
+
+	unsigned				threadCount() const;
+
+	// Jobs submitted from inside a running job land on that thread's own queue.
+	void					submit(Job job);
+
+	// Runs jobs until every submitted job, including the ones they submitted,
+	// has finished.  Must not be called from inside a job.  If any job threw,
+	// the first exception is rethrown here once the rest have finished.
+	void					wait();
+
+
+private:
+	struct Queue
+	{
+		std::mutex			mutex;
+		std::deque<Job>		jobs;
+	};
+
+
+private:
+	void					workerLoop(unsigned index);
+	bool					tryRunOne(unsigned index);
+
+
+private:
+	std::vector<std::unique_ptr<Queue>>	mQueues;
+	std::vector<std::thread>			mThreads;
+
+	// Jobs sitting in a queue, and jobs not yet finished.
+	std::atomic<int>					mQueued;
+	std::atomic<int>					mPending;
+	std::atomic<unsigned>				mNextQueue;
+
+	std::mutex							mErrorMutex;
+	std::exception_ptr					mError;
+
+	std::mutex							mWakeMutex;
+	std::condition_variable				mWake;
+	bool								mStop;
+};
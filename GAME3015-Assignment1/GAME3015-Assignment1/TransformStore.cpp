@@ -0,0 +1,373 @@
+#include "TransformStore.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <cassert>
+
+
+namespace
+{
+	// Slots per pool job.  Small enough to spread a large level over every
+	// thread, large enough that a job outweighs its submission.
+	const std::uint32_t RangeSize = 1024;
+}
+
+TransformStore::TransformStore()
+	: mOrderDirty(false)
+	, mLevelsDirty(false)
+{
+}
+
+TransformStore::Handle TransformStore::create()
+{
+	Handle handle;
+	if (!mFreeHandles.empty())
+	{
+		handle = mFreeHandles.back();
+		mFreeHandles.pop_back();
+	}
+	else
+	{
+		handle = (Handle)mSlotOfHandle.size();
+		mSlotOfHandle.push_back(0);
+	}
+
+	std::uint32_t slot = (std::uint32_t)mPosition.size();
+	mSlotOfHandle[handle] = slot;
+	mHandleOfSlot.push_back(handle);
+
+	mPosition.push_back(XMFLOAT3(0.0f, 0.0f, 0.0f));
+	mRotation.push_back(XMFLOAT4(0.0f, 0.0f, 0.0f, 1.0f));
+	mScale.push_back(XMFLOAT3(1.0f, 1.0f, 1.0f));
+	mVelocity.push_back(XMFLOAT3(0.0f, 0.0f, 0.0f));
+	mParent.push_back(-1);
+	mWorld.push_back(MathHelper::Identity4x4());
+	mDirty.push_back(1);
+	mChanged.push_back(0);
+
+	mLevelsDirty = true;
+	return handle;
+}
+
+void TransformStore::destroy(Handle handle)
+{
+	// The last slot can only be moved into the hole safely while it has no
+	// children, which parent-before-child order guarantees.
+	if (mOrderDirty)
+		sortParentsFirst();
+
+	std::uint32_t slot = mSlotOfHandle[handle];
+	std::uint32_t last = (std::uint32_t)mPosition.size() - 1;
+
+	if (slot != last)
+	{
+		mPosition[slot] = mPosition[last];
+		mRotation[slot] = mRotation[last];
+		mScale[slot] = mScale[last];
+		mVelocity[slot] = mVelocity[last];
+		mParent[slot] = mParent[last];
+		mWorld[slot] = mWorld[last];
+		mDirty[slot] = mDirty[last];
+		mChanged[slot] = mChanged[last];
+
+		Handle moved = mHandleOfSlot[last];
+		mHandleOfSlot[slot] = moved;
+		mSlotOfHandle[moved] = slot;
+
+		if (mParent[slot] > (std::int32_t)slot)
+			mOrderDirty = true;
+	}
+
+	mPosition.pop_back();
+	mRotation.pop_back();
+	mScale.pop_back();
+	mVelocity.pop_back();
+	mParent.pop_back();
+	mWorld.pop_back();
+	mDirty.pop_back();
+	mChanged.pop_back();
+	mHandleOfSlot.pop_back();
+
+	mFreeHandles.push_back(handle);
+	mLevelsDirty = true;
+}
+
+void TransformStore::reserve(std::size_t count)
+{
+	mPosition.reserve(count);
+	mRotation.reserve(count);
+	mScale.reserve(count);
+	mVelocity.reserve(count);
+	mParent.reserve(count);
+	mWorld.reserve(count);
+	mDirty.reserve(count);
+	mChanged.reserve(count);
+	mHandleOfSlot.reserve(count);
+	mSlotOfHandle.reserve(count);
+}
+
+std::size_t TransformStore::size() const
+{
+	return mPosition.size();
+}
+
+void TransformStore::setParent(Handle handle, Handle parent)
+{
+	std::uint32_t slot = mSlotOfHandle[handle];
+
+	if (parent == InvalidHandle)
+	{
+		mParent[slot] = -1;
+	}
+	else
+	{
+		std::uint32_t parentSlot = mSlotOfHandle[parent];
+		mParent[slot] = (std::int32_t)parentSlot;
+
+		if (parentSlot > slot)
+			mOrderDirty = true;
+	}
+
+	mLevelsDirty = true;
+	markDirty(slot);
+}
+
+void TransformStore::setPosition(Handle handle, FXMVECTOR position)
+{
+	std::uint32_t slot = mSlotOfHandle[handle];
+	XMStoreFloat3(&mPosition[slot], position);
+	markDirty(slot);
+}
+
+void TransformStore::setRotation(Handle handle, FXMVECTOR rotation)
+{
+	std::uint32_t slot = mSlotOfHandle[handle];
+	XMStoreFloat4(&mRotation[slot], rotation);
+	markDirty(slot);
+}
+
+void TransformStore::setScale(Handle handle, FXMVECTOR scale)
+{
+	std::uint32_t slot = mSlotOfHandle[handle];
+	XMStoreFloat3(&mScale[slot], scale);
+	markDirty(slot);
+}
+
+void TransformStore::setVelocity(Handle handle, FXMVECTOR velocity)
+{
+	XMStoreFloat3(&mVelocity[mSlotOfHandle[handle]], velocity);
+}
+
+void TransformStore::move(Handle handle, FXMVECTOR offset)
+{
+	std::uint32_t slot = mSlotOfHandle[handle];
+	XMStoreFloat3(&mPosition[slot], XMVectorAdd(XMLoadFloat3(&mPosition[slot]), offset));
+	markDirty(slot);
+}
+
+XMVECTOR TransformStore::getPosition(Handle handle) const
+{
+	return XMLoadFloat3(&mPosition[mSlotOfHandle[handle]]);
+}
+
+XMVECTOR TransformStore::getRotation(Handle handle) const
+{
+	return XMLoadFloat4(&mRotation[mSlotOfHandle[handle]]);
+}
+
+XMVECTOR TransformStore::getScale(Handle handle) const
+{
+	return XMLoadFloat3(&mScale[mSlotOfHandle[handle]]);
+}
+
+XMVECTOR TransformStore::getVelocity(Handle handle) const
+{
+	return XMLoadFloat3(&mVelocity[mSlotOfHandle[handle]]);
+}
+
+XMMATRIX TransformStore::getWorldTransform(Handle handle) const
+{
+	return XMLoadFloat4x4(&mWorld[mSlotOfHandle[handle]]);
+}
+
+bool TransformStore::worldChanged(Handle handle) const
+{
+	return mChanged[mSlotOfHandle[handle]] != 0;
+}
+
+void TransformStore::integrate(float dt)
+{
+	integrateRange(0, (std::uint32_t)mPosition.size(), dt);
+}
+
+void TransformStore::updateWorldTransforms()
+{
+	if (mOrderDirty)
+		sortParentsFirst();
+
+	// Parents always sit in lower slots, so by the time a slot is reached its
+	// parent's world matrix and changed flag are already final.
+	updateWorldRange(0, (std::uint32_t)mPosition.size());
+}
+
+void TransformStore::integrate(float dt, ThreadPool& pool)
+{
+	// Every slot is independent.
+	forEachRange(pool, 0, (std::uint32_t)mPosition.size(),
+		[this, dt](std::uint32_t first, std::uint32_t last) { integrateRange(first, last, dt); });
+}
+
+void TransformStore::updateWorldTransforms(ThreadPool& pool)
+{
+	// Only a store sorted by depth has its levels in contiguous ranges.
+	if (mOrderDirty || mLevelsDirty)
+		sortParentsFirst();
+
+	for (std::size_t level = 0; level + 1 < mLevelStart.size(); ++level)
+	{
+		forEachRange(pool, mLevelStart[level], mLevelStart[level + 1],
+			[this](std::uint32_t first, std::uint32_t last) { updateWorldRange(first, last); });
+	}
+}
+
+void TransformStore::integrateRange(std::uint32_t first, std::uint32_t last, float dt)
+{
+	for (std::uint32_t i = first; i < last; ++i)
+	{
+		const XMFLOAT3& v = mVelocity[i];
+		if (v.x == 0.0f && v.y == 0.0f && v.z == 0.0f)
+			continue;
+
+		mPosition[i].x += v.x * dt;
+		mPosition[i].y += v.y * dt;
+		mPosition[i].z += v.z * dt;
+		mDirty[i] = 1;
+	}
+}
+
+void TransformStore::updateWorldRange(std::uint32_t first, std::uint32_t last)
+{
+	for (std::uint32_t i = first; i < last; ++i)
+	{
+		std::int32_t parent = mParent[i];
+		bool changed = mDirty[i] != 0 || (parent >= 0 && mChanged[parent] != 0);
+
+		mDirty[i] = 0;
+		mChanged[i] = changed ? 1 : 0;
+		if (!changed)
+			continue;
+
+		XMMATRIX world =
+			XMMatrixScaling(mScale[i].x, mScale[i].y, mScale[i].z) *
+			XMMatrixRotationQuaternion(XMLoadFloat4(&mRotation[i])) *
+			XMMatrixTranslation(mPosition[i].x, mPosition[i].y, mPosition[i].z);
+
+		if (parent >= 0)
+			world = world * XMLoadFloat4x4(&mWorld[parent]);
+
+		XMStoreFloat4x4(&mWorld[i], world);
+	}
+}
+
+template<typename Work>
+void TransformStore::forEachRange(ThreadPool& pool, std::uint32_t first, std::uint32_t last, Work work)
+{
+	// Not worth a trip through the pool.
+	if (last - first <= RangeSize)
+	{
+		work(first, last);
+		return;
+	}
+
+	for (std::uint32_t begin = first; begin < last; begin += RangeSize)
+	{
+		std::uint32_t end = std::min(begin + RangeSize, last);
+		pool.submit([work, begin, end]() { work(begin, end); });
+	}
+	pool.wait();
+}
+
+void TransformStore::markDirty(std::uint32_t slot)
+{
+	mDirty[slot] = 1;
+}
+
+void TransformStore::sortParentsFirst()
+{
+	const std::uint32_t count = (std::uint32_t)mPosition.size();
+
+	// Depth of every slot; parents may currently sit after their children, so
+	// walk up until a slot with a known depth is found and fill in on the way back.
+	std::vector<std::int32_t> depth(count, -1);
+	std::vector<std::uint32_t> chain;
+	std::int32_t maxDepth = 0;
+	for (std::uint32_t i = 0; i < count; ++i)
+	{
+		std::int32_t slot = (std::int32_t)i;
+		while (slot >= 0 && depth[slot] < 0)
+		{
+			chain.push_back((std::uint32_t)slot);
+			slot = mParent[slot];
+		}
+
+		std::int32_t d = slot >= 0 ? depth[slot] : -1;
+		while (!chain.empty())
+		{
+			depth[chain.back()] = ++d;
+			chain.pop_back();
+		}
+
+		maxDepth = MathHelper::Max(maxDepth, depth[i]);
+	}
+
+	// Stable counting sort by depth keeps siblings in their current order.
+	std::vector<std::uint32_t> start(maxDepth + 2, 0);
+	for (std::uint32_t i = 0; i < count; ++i)
+		++start[depth[i] + 1];
+	for (std::int32_t d = 1; d <= maxDepth + 1; ++d)
+		start[d] += start[d - 1];
+
+	// Slots now come in one contiguous range per depth level.
+	mLevelStart.assign(start.begin(), start.end());
+
+	std::vector<std::uint32_t> newSlot(count);
+	for (std::uint32_t i = 0; i < count; ++i)
+		newSlot[i] = start[depth[i]]++;
+
+	std::vector<XMFLOAT3> position(count);
+	std::vector<XMFLOAT4> rotation(count);
+	std::vector<XMFLOAT3> scale(count);
+	std::vector<XMFLOAT3> velocity(count);
+	std::vector<std::int32_t> parent(count);
+	std::vector<XMFLOAT4X4> world(count);
+	std::vector<std::uint8_t> dirty(count);
+	std::vector<std::uint8_t> changed(count);
+	std::vector<Handle> handleOfSlot(count);
+
+	for (std::uint32_t i = 0; i < count; ++i)
+	{
+		std::uint32_t n = newSlot[i];
+		position[n] = mPosition[i];
+		rotation[n] = mRotation[i];
+		scale[n] = mScale[i];
+		velocity[n] = mVelocity[i];
+		parent[n] = mParent[i] >= 0 ? (std::int32_t)newSlot[mParent[i]] : -1;
+		world[n] = mWorld[i];
+		dirty[n] = mDirty[i];
+		changed[n] = mChanged[i];
+		handleOfSlot[n] = mHandleOfSlot[i];
+		mSlotOfHandle[mHandleOfSlot[i]] = n;
+	}
+
+	mPosition.swap(position);
+	mRotation.swap(rotation);
+	mScale.swap(scale);
+	mVelocity.swap(velocity);
+	mParent.swap(parent);
+	mWorld.swap(world);
+	mDirty.swap(dirty);
+	mChanged.swap(changed);
+	mHandleOfSlot.swap(handleOfSlot);
+
+	mOrderDirty = false;
+	mLevelsDirty = false;
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include "../../Common/MathHelper.h"
+#include <cstdint>
+#include <vector>
+
+using namespace DirectX;
+
+class ThreadPool;
+
+// Flat structure-of-arrays storage for every scene node transform.  Slots are
+// kept in parent-before-child order so that integration and world matrix
+// composition are single linear sweeps over contiguous arrays.  Scene nodes
+// refer to their transform through a stable handle; slots may be reordered
+// underneath them when the hierarchy changes.
+class TransformStore
+{
+public:
+	typedef std::uint32_t Handle;
+	static const Handle InvalidHandle = UINT32_MAX;
+
+
+public:
+	TransformStore();
+	TransformStore(const TransformStore& rhs) = delete;
+	TransformStore& operator=(const TransformStore& rhs) = delete;
+
+	Handle					create();
+	void					destroy(Handle handle);
+	void					reserve(std::size_t count);
+	std::size_t				size() const;
+
+	void					setParent(Handle handle, Handle parent);
+
+	void					setPosition(Handle handle, FXMVECTOR position);
+	void					setRotation(Handle handle, FXMVECTOR rotation);
+	void					setScale(Handle handle, FXMVECTOR scale);
+	void					setVelocity(Handle handle, FXMVECTOR velocity);
+	void					move(Handle handle, FXMVECTOR offset);
+
+	XMVECTOR				getPosition(Handle handle) const;
+	XMVECTOR				getRotation(Handle handle) const;
+	XMVECTOR				getScale(Handle handle) const;
+	XMVECTOR				getVelocity(Handle handle) const;
+
+	// Valid after the last call to updateWorldTransforms.
+	XMMATRIX				getWorldTransform(Handle handle) const;
+	bool					worldChanged(Handle handle) const;
+
+	// Adds velocity * dt to every position with a non-zero velocity.
+	void					integrate(float dt);
+
+	// Recomposes the world matrix of every slot whose local transform, or whose
+	// parent's world transform, changed since the last sweep.
+	void					updateWorldTransforms();
+
+	// The same sweeps split into ranges of slots run on pool.  World matrices
+	// are composed one depth level at a time, with a wait between levels, so
+	// every parent is final before its children are reached.  Waits for pool
+	// to finish, so must not be called from one of its jobs.
+	void					integrate(float dt, ThreadPool& pool);
+	void					updateWorldTransforms(ThreadPool& pool);
+
+
+private:
+	void					markDirty(std::uint32_t slot);
+	void					sortParentsFirst();
+
+	void					integrateRange(std::uint32_t first, std::uint32_t last, float dt);
+	void					updateWorldRange(std::uint32_t first, std::uint32_t last);
+
+	// Calls work(first, last) on the pool for ranges of at most RangeSize slots
+	// covering [first, last), and waits for them.
+	template<typename Work>
+	void					forEachRange(ThreadPool& pool, std::uint32_t first, std::uint32_t last, Work work);
+
+
+private:
+	std::vector<XMFLOAT3>		mPosition;
+	std::vector<XMFLOAT4>		mRotation;
+	std::vector<XMFLOAT3>		mScale;
+	std::vector<XMFLOAT3>		mVelocity;
+	std::vector<std::int32_t>	mParent;
+	std::vector<XMFLOAT4X4>		mWorld;
+
+	// Pending changes to the local transform, and the result of the last sweep.
+	std::vector<std::uint8_t>	mDirty;
+	std::vector<std::uint8_t>	mChanged;
+
+	std::vector<Handle>			mHandleOfSlot;
+	std::vector<std::uint32_t>	mSlotOfHandle;
+	std::vector<Handle>			mFreeHandles;
+
+	// Set when a slot ended up ahead of its parent.
+	bool						mOrderDirty;
+
+	// First slot of each depth level, plus one past the last slot, as of the
+	// last sortParentsFirst.  Any change to the hierarchy invalidates them.
+	std::vector<std::uint32_t>	mLevelStart;
+	bool						mLevelsDirty;
+};
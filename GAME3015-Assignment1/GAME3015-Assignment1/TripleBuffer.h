@@ -0,0 +1,66 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+// Hands the latest value from one writer thread to one reader thread without
+// either ever waiting for the other.  The writer fills back() and publishes
+// it; the reader acquires whatever was published last, skipping any it missed.
+// The three buffers are reused in turn and keep their contents, so the writer
+// can update a buffer incrementally if it tracks what changed since that
+// buffer's index was last published.
+template<typename T>
+class TripleBuffer
+{
+public:
+	static const int BufferCount = 3;
+
+
+public:
+	TripleBuffer()
+		: mFront(0)
+		, mMiddle(1)
+		, mBack(2)
+	{
+	}
+
+	TripleBuffer(const TripleBuffer& rhs) = delete;
+	TripleBuffer& operator=(const TripleBuffer& rhs) = delete;
+
+	// Writer side.
+	T&						back() { return mBuffers[mBack]; }
+	int						backIndex() const { return mBack; }
+
+	void					publish()
+	{
+		mBack = (int)(mMiddle.exchange((std::uint32_t)mBack | FreshBit, std::memory_order_acq_rel) & IndexMask);
+	}
+
+	// Reader side.  Returns false, and keeps the current front buffer, if
+	// nothing was published since the last call.
+	bool					acquire()
+	{
+		if ((mMiddle.load(std::memory_order_relaxed) & FreshBit) == 0)
+			return false;
+
+		mFront = (int)(mMiddle.exchange((std::uint32_t)mFront, std::memory_order_acq_rel) & IndexMask);
+		return true;
+	}
+
+	const T&				front() const { return mBuffers[mFront]; }
+
+
+private:
+	static const std::uint32_t	IndexMask = 3;
+	static const std::uint32_t	FreshBit = 4;
+
+
+private:
+	T							mBuffers[BufferCount];
+
+	// The buffer between the two threads, with FreshBit set while the reader
+	// has not picked it up yet.
+	int							mFront;
+	std::atomic<std::uint32_t>	mMiddle;
+	int							mBack;
+};
@@ -0,0 +1,108 @@
+#include "UploadAllocator.h"
+
+
+UploadAllocator::UploadAllocator(ID3D12Device* device, UINT64 pageSize)
+	: mDevice(device)
+	, mCurrentPage(0)
+	, mOffset(0)
+	, mUsed(0)
+{
+	addPage(pageSize);
+}
+
+UploadAllocator::~UploadAllocator()
+{
+	releasePages();
+}
+
+UploadAllocator::Allocation UploadAllocator::allocate(UINT64 size, UINT64 alignment)
+{
+	assert((alignment & (alignment - 1)) == 0);
+
+	UINT64 offset = (mOffset + alignment - 1) & ~(alignment - 1);
+	if (offset + size > mPages[mCurrentPage].Size)
+	{
+		// Pages are created aligned, so a fresh one needs no padding.
+		UINT64 nextSize = mPages[mCurrentPage].Size * 2;
+		if (nextSize < size)
+			nextSize = size;
+
+		mUsed += mPages[mCurrentPage].Size - mOffset;
+		addPage(nextSize);
+		mCurrentPage = mPages.size() - 1;
+		mOffset = 0;
+		offset = 0;
+	}
+
+	Page& page = mPages[mCurrentPage];
+	mUsed += offset + size - mOffset;
+	mOffset = offset + size;
+
+	Allocation allocation;
+	allocation.CpuAddress = page.MappedData + offset;
+	allocation.GpuAddress = page.GpuAddress + offset;
+	return allocation;
+}
+
+void UploadAllocator::reset()
+{
+	// Replace a chain of pages with one page that fits everything last frame needed.
+	if (mPages.size() > 1)
+	{
+		UINT64 size = capacity();
+		releasePages();
+		addPage(size);
+	}
+
+	mCurrentPage = 0;
+	mOffset = 0;
+	mUsed = 0;
+}
+
+UINT64 UploadAllocator::capacity() const
+{
+	UINT64 size = 0;
+	for (const Page& page : mPages)
+		size += page.Size;
+	return size;
+}
+
+UINT64 UploadAllocator::used() const
+{
+	return mUsed;
+}
+
+void UploadAllocator::addPage(UINT64 size)
+{
+	// Keep every page a whole number of constant buffer slots.
+	const UINT64 alignment = D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT;
+	size = (size + alignment - 1) & ~(alignment - 1);
+
+	Page page;
+	page.Size = size;
+
+	ThrowIfFailed(mDevice->CreateCommittedResource(
+		&CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD),
+		D3D12_HEAP_FLAG_NONE,
+		&CD3DX12_RESOURCE_DESC::Buffer(size),
+		D3D12_RESOURCE_STATE_GENERIC_READ,
+		nullptr,
+		IID_PPV_ARGS(&page.Resource)));
+
+	// Stays mapped for the lifetime of the page.  We must not write to memory the
+	// GPU is still reading, which is what the frame resource fences are for.
+	ThrowIfFailed(page.Resource->Map(0, nullptr, reinterpret_cast<void**>(&page.MappedData)));
+	page.GpuAddress = page.Resource->GetGPUVirtualAddress();
+
+	mPages.push_back(page);
+}
+
+void UploadAllocator::releasePages()
+{
+	for (Page& page : mPages)
+	{
+		if (page.Resource != nullptr)
+			page.Resource->Unmap(0, nullptr);
+	}
+	mPages.clear();
+}
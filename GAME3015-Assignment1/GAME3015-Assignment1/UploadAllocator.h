@@ -0,0 +1,61 @@
+#pragma once
+
+#include "../../Common/d3dUtil.h"
+#include <vector>
+
+// Linear allocator over persistently mapped upload heap pages.  Hands out
+// suballocations for data that only has to live for one frame, 256-byte
+// aligned by default so any of them can be bound as a constant buffer.
+// When a page fills up another one is added; the next reset folds all pages
+// into one big enough for the whole frame, so a growing workload settles on a
+// single page after one frame.
+class UploadAllocator
+{
+public:
+	struct Allocation
+	{
+		void*						CpuAddress = nullptr;
+		D3D12_GPU_VIRTUAL_ADDRESS	GpuAddress = 0;
+	};
+
+
+public:
+	UploadAllocator(ID3D12Device* device, UINT64 pageSize);
+	UploadAllocator(const UploadAllocator& rhs) = delete;
+	UploadAllocator& operator=(const UploadAllocator& rhs) = delete;
+	~UploadAllocator();
+
+	Allocation				allocate(UINT64 size, UINT64 alignment = D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT);
+
+	// Starts over at the beginning of the first page.  Only call this once the
+	// GPU has finished with everything allocated since the last reset.
+	void					reset();
+
+	UINT64					capacity() const;
+	UINT64					used() const;
+
+
+private:
+	struct Page
+	{
+		Microsoft::WRL::ComPtr<ID3D12Resource>	Resource;
+		BYTE*									MappedData = nullptr;
+		D3D12_GPU_VIRTUAL_ADDRESS				GpuAddress = 0;
+		UINT64									Size = 0;
+	};
+
+
+private:
+	void					addPage(UINT64 size);
+	void					releasePages();
+
+
+private:
+	ID3D12Device*			mDevice;
+	std::vector<Page>		mPages;
+	std::size_t				mCurrentPage;
+	UINT64					mOffset;
+
+	// Bytes handed out since the last reset, padding included.
+	UINT64					mUsed;
+};
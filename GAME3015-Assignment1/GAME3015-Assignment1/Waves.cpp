@@ -3,13 +3,31 @@
 //***************************************************************************************
 
 #include "Waves.h"
-#include <ppl.h>
+#include "ThreadPool.h"
 #include <algorithm>
 #include <vector>
 #include <cassert>
+#include <cmath>
+#include <cstdint>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
 
 using namespace DirectX;
 
+namespace
+{
+	// Interior points are stepped, and put to sleep, in tiles of this size.
+	// A tile's rows stay in cache while it is stepped.  Tiles are wider than
+	// they are tall since rows are contiguous.
+	const int TileRows = 32;
+	const int TileColumns = 256;
+
+	// More bands than threads, so a thread that is held up does not hold up
+	// the whole pass.  Bands are at least a tile row.
+	const int BandsPerThread = 4;
+}
+
 Waves::Waves(int m, int n, float dx, float dt, float speed, float damping)
 {
     mNumRows = m;
@@ -20,6 +38,7 @@ Waves::Waves(int m, int n, float dx, float dt, float speed, float damping)
 
     mTimeStep = dt;
     mSpatialStep = dx;
+    mStepClock = FixedTimestep(dt);
 
     float d = damping*dt + 2.0f;
     float e = (speed*speed)*(dt*dt) / (dx*dx);
@@ -27,34 +46,102 @@ Waves::Waves(int m, int n, float dx, float dt, float speed, float damping)
     mK2 = (4.0f - 8.0f*e) / d;
     mK3 = (2.0f*e) / d;
 
-    mPrevSolution.resize(m*n);
-    mCurrSolution.resize(m*n);
-    mNormals.resize(m*n);
-    mTangentX.resize(m*n);
+    // Cache line aligned rows also suit 16- and 32-byte vector loads.
+    const int lineFloats = 64 / sizeof(float);
+    mRowPitch = (n + lineFloats - 1) / lineFloats * lineFloats;
 
-    // Generate grid vertices in system memory.
+    mPrevSolution.Allocate(m*mRowPitch);
+    mCurrSolution.Allocate(m*mRowPitch);
 
+    // The water starts flat.  Only heights change, so the rest of every
+    // vertex is generated from these when it is written.
     float halfWidth = (n - 1)*dx*0.5f;
-    float halfDepth = (m - 1)*dx*0.5f;
-    for(int i = 0; i < m; ++i)
+    mColumnX.resize(n);
+    mColumnU.resize(n);
+    for(int j = 0; j < n; ++j)
     {
-        float z = halfDepth - i*dx;
-        for(int j = 0; j < n; ++j)
-        {
-            float x = -halfWidth + j*dx;
-
-            mPrevSolution[i*n + j] = XMFLOAT3(x, 0.0f, z);
-            mCurrSolution[i*n + j] = XMFLOAT3(x, 0.0f, z);
-            mNormals[i*n + j] = XMFLOAT3(0.0f, 1.0f, 0.0f);
-            mTangentX[i*n + j] = XMFLOAT3(1.0f, 0.0f, 0.0f);
-        }
+        mColumnX[j] = -halfWidth + j*dx;
+
+        // Derive tex-coords from position by 
+        // mapping [-w/2,w/2] --> [0,1]
+        mColumnU[j] = 0.5f + mColumnX[j] / Width();
     }
+
+    // Flat water is at rest, so every tile starts asleep.
+    mTileRows = std::max(0, (m - 2 + TileRows - 1) / TileRows);
+    mTileCols = std::max(0, (n - 2 + TileColumns - 1) / TileColumns);
+    mTileAwake.assign(mTileRows*mTileCols, 0);
+    mTileActive.assign(mTileRows*mTileCols, 0);
+    mTileMax.assign(mTileRows*mTileCols, 0.0f);
 }
 
 Waves::~Waves()
 {
 }
 
+void Waves::HeightField::Allocate(std::size_t count)
+{
+	const std::size_t alignment = 64;
+
+	Storage.assign(count + alignment / sizeof(float), 0.0f);
+	std::uintptr_t address = (std::uintptr_t)Storage.data();
+	Data = Storage.data() + ((alignment - address % alignment) % alignment) / sizeof(float);
+}
+
+XMFLOAT3 Waves::Position(int i)const
+{
+	const int row = i / mNumCols;
+	const int col = i % mNumCols;
+
+	float halfDepth = (mNumRows - 1)*mSpatialStep*0.5f;
+
+	return XMFLOAT3(mColumnX[col], mCurrSolution.Data[row*mRowPitch + col], halfDepth - row*mSpatialStep);
+}
+
+namespace
+{
+	// Finite difference normal and x tangent from the heights left, right,
+	// above (t) and below (b) a grid point.
+	XMFLOAT3 gridNormal(float l, float r, float t, float b, float dx)
+	{
+		XMFLOAT3 normal(-r+l, 2.0f*dx, b-t);
+		XMStoreFloat3(&normal, XMVector3Normalize(XMLoadFloat3(&normal)));
+		return normal;
+	}
+
+	XMFLOAT3 gridTangentX(float l, float r, float dx)
+	{
+		XMFLOAT3 tangent(2.0f*dx, r-l, 0.0f);
+		XMStoreFloat3(&tangent, XMVector3Normalize(XMLoadFloat3(&tangent)));
+		return tangent;
+	}
+}
+
+XMFLOAT3 Waves::Normal(int i)const
+{
+	const int row = i / mNumCols;
+	const int col = i % mNumCols;
+
+	// The boundary never moves.
+	if(row == 0 || row == mNumRows-1 || col == 0 || col == mNumCols-1)
+		return XMFLOAT3(0.0f, 1.0f, 0.0f);
+
+	const float* h = mCurrSolution.Data + row*mRowPitch + col;
+	return gridNormal(h[-1], h[1], h[-mRowPitch], h[mRowPitch], mSpatialStep);
+}
+
+XMFLOAT3 Waves::TangentX(int i)const
+{
+	const int row = i / mNumCols;
+	const int col = i % mNumCols;
+
+	if(row == 0 || row == mNumRows-1 || col == 0 || col == mNumCols-1)
+		return XMFLOAT3(1.0f, 0.0f, 0.0f);
+
+	const float* h = mCurrSolution.Data + row*mRowPitch + col;
+	return gridTangentX(h[-1], h[1], mSpatialStep);
+}
+
 int Waves::RowCount()const
 {
 	return mNumRows;
@@ -85,72 +172,400 @@ float Waves::Depth()const
 	return mNumRows*mSpatialStep;
 }
 
-void Waves::Update(float dt)
+namespace
 {
-	static float t = 0;
+	int bandStart(int firstRow, int rowCount, int band, int bandCount)
+	{
+		if(band == bandCount)
+			return firstRow + rowCount;
 
-	// Accumulate time.
-	t += dt;
+		// Bands start on a tile row, so every tile is stepped by one band.
+		return firstRow + rowCount*band/bandCount/TileRows*TileRows;
+	}
 
-	// Only update the simulation at the specified time step.
-	if( t >= mTimeStep )
+	// Overwrites prev[j] with k1*prev + k2*curr + k3*(down + up + right + left)
+	// for columns [first, last) of one row, and returns the largest magnitude
+	// among largest and the old and new heights of the row.  Every width sums
+	// in the same order, so the vector paths give the same bits as the scalar
+	// one, but only as long as the compiler does not contract the multiplies
+	// and adds into fused multiply-adds: GCC and Clang do that to the vector
+	// intrinsics too unless built with -ffp-contract=off, which the CMake build
+	// sets for this file.  MSVC only contracts under /fp:contract.  The scalar
+	// tail uses single-lane SSE where that is available so it rounds like the
+	// vector paths whatever the flags.
+	float solveRow(float* prev, const float* curr, const float* up, const float* down,
+		int first, int last, float k1, float k2, float k3, float largest)
 	{
-		// Only update interior points; we use zero boundary conditions.
-		concurrency::parallel_for(1, mNumRows - 1, [this](int i)
-		//for(int i = 1; i < mNumRows-1; ++i)
+		int j = first;
+
+#if defined(__AVX2__)
 		{
-			for(int j = 1; j < mNumCols-1; ++j)
+			const __m256 vk1 = _mm256_set1_ps(k1);
+			const __m256 vk2 = _mm256_set1_ps(k2);
+			const __m256 vk3 = _mm256_set1_ps(k3);
+			const __m256 signMask = _mm256_set1_ps(-0.0f);
+			__m256 vmax = _mm256_set1_ps(largest);
+			for(; j + 8 <= last; j += 8)
 			{
-				// After this update we will be discarding the old previous
-				// buffer, so overwrite that buffer with the new update.
-				// Note how we can do this inplace (read/write to same element) 
-				// because we won't need prev_ij again and the assignment happens last.
-
-				// Note j indexes x and i indexes z: h(x_j, z_i, t_k)
-				// Moreover, our +z axis goes "down"; this is just to 
-				// keep consistent with our row indices going down.
-
-				mPrevSolution[i*mNumCols+j].y = 
-					mK1*mPrevSolution[i*mNumCols+j].y +
-					mK2*mCurrSolution[i*mNumCols+j].y +
-					mK3*(mCurrSolution[(i+1)*mNumCols+j].y + 
-					     mCurrSolution[(i-1)*mNumCols+j].y + 
-					     mCurrSolution[i*mNumCols+j+1].y + 
-						 mCurrSolution[i*mNumCols+j-1].y);
+				__m256 sum = _mm256_add_ps(_mm256_loadu_ps(down + j), _mm256_loadu_ps(up + j));
+				sum = _mm256_add_ps(sum, _mm256_loadu_ps(curr + j + 1));
+				sum = _mm256_add_ps(sum, _mm256_loadu_ps(curr + j - 1));
+
+				__m256 c = _mm256_loadu_ps(curr + j);
+				__m256 h = _mm256_add_ps(_mm256_mul_ps(vk1, _mm256_loadu_ps(prev + j)), _mm256_mul_ps(vk2, c));
+				h = _mm256_add_ps(h, _mm256_mul_ps(vk3, sum));
+				_mm256_storeu_ps(prev + j, h);
+
+				vmax = _mm256_max_ps(vmax, _mm256_andnot_ps(signMask, c));
+				vmax = _mm256_max_ps(vmax, _mm256_andnot_ps(signMask, h));
 			}
-		});
+			__m128 half = _mm_max_ps(_mm256_castps256_ps128(vmax), _mm256_extractf128_ps(vmax, 1));
+			half = _mm_max_ps(half, _mm_movehl_ps(half, half));
+			half = _mm_max_ss(half, _mm_shuffle_ps(half, half, 1));
+			largest = _mm_cvtss_f32(half);
+		}
+#endif
 
-		// We just overwrote the previous buffer with the new data, so
-		// this data needs to become the current solution and the old
-		// current solution becomes the new previous solution.
-		std::swap(mPrevSolution, mCurrSolution);
+#if defined(_XM_SSE_INTRINSICS_)
+		{
+			const __m128 vk1 = _mm_set1_ps(k1);
+			const __m128 vk2 = _mm_set1_ps(k2);
+			const __m128 vk3 = _mm_set1_ps(k3);
+			const __m128 signMask = _mm_set1_ps(-0.0f);
+			__m128 vmax = _mm_set1_ps(largest);
+			for(; j + 4 <= last; j += 4)
+			{
+				__m128 sum = _mm_add_ps(_mm_loadu_ps(down + j), _mm_loadu_ps(up + j));
+				sum = _mm_add_ps(sum, _mm_loadu_ps(curr + j + 1));
+				sum = _mm_add_ps(sum, _mm_loadu_ps(curr + j - 1));
 
-		t = 0.0f; // reset time
+				__m128 c = _mm_loadu_ps(curr + j);
+				__m128 h = _mm_add_ps(_mm_mul_ps(vk1, _mm_loadu_ps(prev + j)), _mm_mul_ps(vk2, c));
+				h = _mm_add_ps(h, _mm_mul_ps(vk3, sum));
+				_mm_storeu_ps(prev + j, h);
 
-		//
-		// Compute normals using finite difference scheme.
-		//
-		concurrency::parallel_for(1, mNumRows - 1, [this](int i)
-		//for(int i = 1; i < mNumRows - 1; ++i)
+				vmax = _mm_max_ps(vmax, _mm_andnot_ps(signMask, c));
+				vmax = _mm_max_ps(vmax, _mm_andnot_ps(signMask, h));
+			}
+			vmax = _mm_max_ps(vmax, _mm_movehl_ps(vmax, vmax));
+			vmax = _mm_max_ss(vmax, _mm_shuffle_ps(vmax, vmax, 1));
+			largest = _mm_cvtss_f32(vmax);
+		}
+#endif
+
+#if defined(_XM_SSE_INTRINSICS_)
 		{
-			for(int j = 1; j < mNumCols-1; ++j)
+			const __m128 sk1 = _mm_set_ss(k1);
+			const __m128 sk2 = _mm_set_ss(k2);
+			const __m128 sk3 = _mm_set_ss(k3);
+			for(; j < last; ++j)
 			{
-				float l = mCurrSolution[i*mNumCols+j-1].y;
-				float r = mCurrSolution[i*mNumCols+j+1].y;
-				float t = mCurrSolution[(i-1)*mNumCols+j].y;
-				float b = mCurrSolution[(i+1)*mNumCols+j].y;
-				mNormals[i*mNumCols+j].x = -r+l;
-				mNormals[i*mNumCols+j].y = 2.0f*mSpatialStep;
-				mNormals[i*mNumCols+j].z = b-t;
-
-				XMVECTOR n = XMVector3Normalize(XMLoadFloat3(&mNormals[i*mNumCols+j]));
-				XMStoreFloat3(&mNormals[i*mNumCols+j], n);
-
-				mTangentX[i*mNumCols+j] = XMFLOAT3(2.0f*mSpatialStep, r-l, 0.0f);
-				XMVECTOR T = XMVector3Normalize(XMLoadFloat3(&mTangentX[i*mNumCols+j]));
-				XMStoreFloat3(&mTangentX[i*mNumCols+j], T);
+				__m128 sum = _mm_add_ss(_mm_load_ss(down + j), _mm_load_ss(up + j));
+				sum = _mm_add_ss(sum, _mm_load_ss(curr + j + 1));
+				sum = _mm_add_ss(sum, _mm_load_ss(curr + j - 1));
+
+				__m128 c = _mm_load_ss(curr + j);
+				__m128 h = _mm_add_ss(_mm_mul_ss(sk1, _mm_load_ss(prev + j)), _mm_mul_ss(sk2, c));
+				h = _mm_add_ss(h, _mm_mul_ss(sk3, sum));
+				_mm_store_ss(prev + j, h);
+
+				largest = std::max(largest, std::max(std::fabs(_mm_cvtss_f32(c)), std::fabs(_mm_cvtss_f32(h))));
 			}
+		}
+#else
+		for(; j < last; ++j)
+		{
+			prev[j] = k1*prev[j] + k2*curr[j] + k3*(down[j] + up[j] + curr[j+1] + curr[j-1]);
+			largest = std::max(largest, std::max(std::fabs(curr[j]), std::fabs(prev[j])));
+		}
+#endif
+		return largest;
+	}
+}
+
+int Waves::StepsDue(float dt)
+{
+	// Without a time step every update steps once, as it always has.
+	if( mTimeStep <= 0.0f )
+		return 1;
+
+	return mStepClock.advance(dt);
+}
+
+void Waves::Update(float dt)
+{
+	const int steps = StepsDue(dt);
+	for(int i = 0; i < steps; ++i)
+		Step();
+}
+
+void Waves::Update(float dt, Vertex* vertices)
+{
+	const int steps = StepsDue(dt);
+	if( steps == 0 )
+	{
+		ForEachRowBand(0, mNumRows, [this, vertices](int firstRow, int lastRow)
+		{
+			EmitRows(firstRow, lastRow, mCurrSolution.Data, vertices);
 		});
+		return;
+	}
+
+	// Only the last step is drawn, so only it needs emitting.
+	for(int i = 1; i < steps; ++i)
+		Step();
+
+	FindActiveTiles();
+	ForEachRowBand(1, mNumRows - 1, [this, vertices](int firstRow, int lastRow)
+	{
+		SolveAndEmitRows(firstRow, lastRow, vertices);
+	});
+
+	// What the bands left: the boundary rows, and the rows either side of
+	// every seam between two bands.  The new heights are still in the
+	// previous buffer until the swap.
+	const float* heights = mPrevSolution.Data;
+	EmitRows(0, 1, heights, vertices);
+	EmitRows(mNumRows - 1, mNumRows, heights, vertices);
+
+	const int interiorRows = mNumRows - 2;
+	const int bandCount = BandCount(interiorRows);
+	for(int band = 1; band < bandCount; ++band)
+	{
+		int seam = bandStart(1, interiorRows, band, bandCount);
+		EmitRows(seam - 1, seam + 1, heights, vertices);
+	}
+
+	std::swap(mPrevSolution, mCurrSolution);
+	SettleTiles();
+}
+
+void Waves::SetSubStepping(int maxStepsPerUpdate, double catchUpBudget)
+{
+	mStepClock = FixedTimestep(mTimeStep, maxStepsPerUpdate, catchUpBudget);
+}
+
+void Waves::SetSleepThreshold(float epsilon)
+{
+	mSleepThreshold = epsilon;
+}
+
+int Waves::TileCount()const
+{
+	return mTileRows*mTileCols;
+}
+
+int Waves::ActiveTileCount()const
+{
+	return mActiveTileCount;
+}
+
+void Waves::Step()
+{
+	FindActiveTiles();
+
+	// Only update interior points; we use zero boundary conditions.
+	ForEachRowBand(1, mNumRows - 1, [this](int firstRow, int lastRow) { SolveRows(firstRow, lastRow); });
+
+	// We just overwrote the previous buffer with the new data, so
+	// this data needs to become the current solution and the old
+	// current solution becomes the new previous solution.
+	std::swap(mPrevSolution, mCurrSolution);
+
+	SettleTiles();
+}
+
+void Waves::FindActiveTiles()
+{
+	mActiveTileCount = 0;
+	for(int r = 0; r < mTileRows; ++r)
+	{
+		for(int c = 0; c < mTileCols; ++c)
+		{
+			const int tile = r*mTileCols + c;
+			const bool active = mTileAwake[tile] ||
+				(r > 0 && mTileAwake[tile - mTileCols]) ||
+				(r < mTileRows-1 && mTileAwake[tile + mTileCols]) ||
+				(c > 0 && mTileAwake[tile - 1]) ||
+				(c < mTileCols-1 && mTileAwake[tile + 1]);
+
+			mTileActive[tile] = active;
+			if(active)
+			{
+				mTileMax[tile] = 0.0f;
+				++mActiveTileCount;
+			}
+		}
+	}
+}
+
+void Waves::SettleTiles()
+{
+	for(int tile = 0; tile < mTileRows*mTileCols; ++tile)
+	{
+		if(!mTileActive[tile])
+			continue;
+
+		mTileAwake[tile] = mTileMax[tile] > mSleepThreshold;
+		if(mTileAwake[tile] || mTileMax[tile] == 0.0f)
+			continue;
+
+		// Close enough to rest; make it exactly rest, so that skipping the
+		// tile from now on gives the same heights as stepping it would.
+		const int i0 = 1 + tile/mTileCols*TileRows;
+		const int i1 = std::min(i0 + TileRows, mNumRows-1);
+		const int j0 = 1 + tile%mTileCols*TileColumns;
+		const int j1 = std::min(j0 + TileColumns, mNumCols-1);
+		for(int i = i0; i < i1; ++i)
+		{
+			std::fill(mCurrSolution.Data + i*mRowPitch + j0, mCurrSolution.Data + i*mRowPitch + j1, 0.0f);
+			std::fill(mPrevSolution.Data + i*mRowPitch + j0, mPrevSolution.Data + i*mRowPitch + j1, 0.0f);
+		}
+	}
+}
+
+void Waves::WakeTile(int i, int j)
+{
+	mTileAwake[(i - 1)/TileRows*mTileCols + (j - 1)/TileColumns] = 1;
+}
+
+void Waves::SetThreadPool(ThreadPool* pool)
+{
+	mThreadPool = pool;
+}
+
+int Waves::BandCount(int rowCount)const
+{
+	if(mThreadPool == nullptr)
+		return 1;
+
+	return std::max(1, std::min((int)mThreadPool->threadCount()*BandsPerThread, rowCount/TileRows));
+}
+
+template<typename RowFunc>
+void Waves::ForEachRowBand(int firstRow, int lastRow, RowFunc rows)
+{
+	const int rowCount = lastRow - firstRow;
+	if(rowCount <= 0)
+		return;
+
+	const int bandCount = BandCount(rowCount);
+	if(bandCount == 1)
+	{
+		rows(firstRow, lastRow);
+		return;
+	}
+
+	// Bands only write their own rows, so they need no synchronisation
+	// beyond waiting for all of them before the next pass reads the result.
+	for(int band = 0; band < bandCount; ++band)
+	{
+		int bandFirst = bandStart(firstRow, rowCount, band, bandCount);
+		int bandLast = bandStart(firstRow, rowCount, band + 1, bandCount);
+		mThreadPool->submit([rows, bandFirst, bandLast]() { rows(bandFirst, bandLast); });
+	}
+	mThreadPool->wait();
+}
+
+void Waves::SolveRows(int firstRow, int lastRow)
+{
+	for(int i0 = firstRow; i0 < lastRow; i0 += TileRows)
+	{
+		const int i1 = std::min(i0 + TileRows, lastRow);
+		const int tileRow = (i0 - 1)/TileRows;
+		for(int tileCol = 0; tileCol < mTileCols; ++tileCol)
+		{
+			if(!mTileActive[tileRow*mTileCols + tileCol])
+				continue;
+
+			const int j0 = 1 + tileCol*TileColumns;
+			const int j1 = std::min(j0 + TileColumns, mNumCols-1);
+			for(int i = i0; i < i1; ++i)
+				SolveSegment(i, j0, j1);
+		}
+	}
+}
+
+void Waves::SolveSegment(int i, int firstCol, int lastCol)
+{
+	// After this update we will be discarding the old previous
+	// buffer, so overwrite that buffer with the new update.
+	// Note how we can do this inplace (read/write to same element) 
+	// because we won't need prev_ij again and the assignment happens last.
+
+	// Note j indexes x and i indexes z: h(x_j, z_i, t_k)
+	// Moreover, our +z axis goes "down"; this is just to 
+	// keep consistent with our row indices going down.
+	float* next = mPrevSolution.Data + i*mRowPitch;
+	const float* curr = mCurrSolution.Data + i*mRowPitch;
+	// Only one band steps any tile, so its largest height needs no
+	// synchronisation.
+	float& tileMax = mTileMax[(i - 1)/TileRows*mTileCols + (firstCol - 1)/TileColumns];
+	tileMax = solveRow(next, curr, curr - mRowPitch, curr + mRowPitch, firstCol, lastCol, mK1, mK2, mK3, tileMax);
+}
+
+void Waves::SolveAndEmitRows(int firstRow, int lastRow, Vertex* vertices)
+{
+	// Rows next to the boundary only need the boundary, which never changes.
+	const int emitFirst = firstRow == 1 ? firstRow : firstRow + 1;
+	const int emitLast = lastRow == mNumRows - 1 ? lastRow : lastRow - 1;
+
+	// Row by row rather than tile by tile: a row is emitted while the three
+	// rows it was stepped from are still in cache.
+	const float* heights = mPrevSolution.Data;
+	int nextEmit = emitFirst;
+	for(int i = firstRow; i < lastRow; ++i)
+	{
+		const std::uint8_t* active = mTileActive.data() + (i - 1)/TileRows*mTileCols;
+		for(int tileCol = 0; tileCol < mTileCols; ++tileCol)
+		{
+			if(active[tileCol])
+			{
+				const int j0 = 1 + tileCol*TileColumns;
+				SolveSegment(i, j0, std::min(j0 + TileColumns, mNumCols-1));
+			}
+		}
+
+		// Every row above this one now has new heights on both sides.
+		const int ready = std::min(i, emitLast);
+		if(nextEmit < ready)
+		{
+			EmitRows(nextEmit, ready, heights, vertices);
+			nextEmit = ready;
+		}
+	}
+
+	EmitRows(nextEmit, emitLast, heights, vertices);
+}
+
+void Waves::EmitRows(int firstRow, int lastRow, const float* heights, Vertex* vertices)const
+{
+	const float halfDepth = (mNumRows - 1)*mSpatialStep*0.5f;
+	const XMFLOAT3 up(0.0f, 1.0f, 0.0f);
+
+	for(int i = firstRow; i < lastRow; ++i)
+	{
+		const float* h = heights + i*mRowPitch;
+		Vertex* out = vertices + i*mNumCols;
+
+		const float z = halfDepth - i*mSpatialStep;
+		const float v = 0.5f - z / Depth();
+
+		// Boundary points keep the normal of flat water.
+		const bool boundaryRow = i == 0 || i == mNumRows - 1;
+		for(int j = 0; j < mNumCols; ++j)
+		{
+			Vertex vertex;
+			vertex.Pos = XMFLOAT3(mColumnX[j], h[j], z);
+			if(boundaryRow || j == 0 || j == mNumCols - 1)
+				vertex.Normal = up;
+			else
+				vertex.Normal = gridNormal(h[j-1], h[j+1], h[j-mRowPitch], h[j+mRowPitch], mSpatialStep);
+			vertex.TexC = XMFLOAT2(mColumnU[j], v);
+
+			// Written in one go; the destination may be write-combined.
+			out[j] = vertex;
+		}
 	}
 }
 
@@ -162,11 +577,18 @@ void Waves::Disturb(int i, int j, float magnitude)
 
 	float halfMag = 0.5f*magnitude;
 
+	WakeTile(i, j);
+	WakeTile(i, j+1);
+	WakeTile(i, j-1);
+	WakeTile(i+1, j);
+	WakeTile(i-1, j);
+
 	// Disturb the ijth vertex height and its neighbors.
-	mCurrSolution[i*mNumCols+j].y     += magnitude;
-	mCurrSolution[i*mNumCols+j+1].y   += halfMag;
-	mCurrSolution[i*mNumCols+j-1].y   += halfMag;
-	mCurrSolution[(i+1)*mNumCols+j].y += halfMag;
-	mCurrSolution[(i-1)*mNumCols+j].y += halfMag;
+	float* h = mCurrSolution.Data + i*mRowPitch + j;
+	h[0]          += magnitude;
+	h[1]          += halfMag;
+	h[-1]         += halfMag;
+	h[mRowPitch]  += halfMag;
+	h[-mRowPitch] += halfMag;
 }
 	
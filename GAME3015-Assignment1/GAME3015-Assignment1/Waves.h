@@ -9,8 +9,12 @@
 #ifndef WAVES_H
 #define WAVES_H
 
+#include <cstdint>
 #include <vector>
 #include <DirectXMath.h>
+#include "../../Common/FixedTimestep.h"
+
+class ThreadPool;
 
 class Waves
 {
@@ -27,18 +31,110 @@ public:
 	float Width()const;
 	float Depth()const;
 
-	// Returns the solution at the ith grid point.
-    const DirectX::XMFLOAT3& Position(int i)const { return mCurrSolution[i]; }
+	// Returns the solution at the ith grid point.  Only heights are stored;
+	// x and z are rebuilt from the grid.
+    DirectX::XMFLOAT3 Position(int i)const;
 
-	// Returns the solution normal at the ith grid point.
-    const DirectX::XMFLOAT3& Normal(int i)const { return mNormals[i]; }
+	// Returns the solution normal at the ith grid point.  Normals are not
+	// stored; they are worked out from the heights when asked for.
+    DirectX::XMFLOAT3 Normal(int i)const;
 
 	// Returns the unit tangent vector at the ith grid point in the local x-axis direction.
-    const DirectX::XMFLOAT3& TangentX(int i)const { return mTangentX[i]; }
+    DirectX::XMFLOAT3 TangentX(int i)const;
+
+	// Laid out like the apps' Vertex.
+	struct Vertex
+	{
+		DirectX::XMFLOAT3 Pos;
+		DirectX::XMFLOAT3 Normal;
+		DirectX::XMFLOAT2 TexC;
+	};
 
 	void Update(float dt);
+
+	// As Update, and writes every grid point to vertices[i] with its normal
+	// and texture coordinates, in the same sweep that steps the heights.  The
+	// vertices are written whole and never read back, so they can go straight
+	// into an upload buffer.  They are written even when no step is due.
+	void Update(float dt, Vertex* vertices);
+
 	void Disturb(int i, int j, float magnitude);
 
+	// Update takes as many fixed steps as the time passed calls for, up to
+	// maxStepsPerUpdate.  Up to catchUpBudget seconds beyond that are made up
+	// over later updates; the rest is dropped.  By default up to 8 steps are
+	// taken and nothing is made up.  Waves made with a time step of 0 step
+	// once per Update whatever the time passed, and ignore this.
+	void SetSubStepping(int maxStepsPerUpdate, double catchUpBudget = 0.0);
+
+	// The interior is split into tiles.  A tile whose heights stay within
+	// epsilon of rest in both time levels goes to sleep: it is put at rest
+	// and not stepped again until Disturb or an active neighbour wakes it.
+	// With the default of 0 only tiles exactly at rest sleep, which changes
+	// no results; a larger epsilon trades accuracy for skipping more water.
+	void SetSleepThreshold(float epsilon);
+
+	int TileCount()const;
+
+	// Tiles stepped by the last step.
+	int ActiveTileCount()const;
+
+	// Splits each pass of Update into bands of rows and runs them on pool.
+	// Without a pool they run on the calling thread.  Every grid point is
+	// computed by the same code from the same inputs either way, so the
+	// results are bitwise identical.
+	void SetThreadPool(ThreadPool* pool);
+
+private:
+	// Heights of one time level.  Rows are mRowPitch floats apart and start
+	// on a cache line, so vector loads and stores never split one needlessly
+	// and no two row bands share a line.
+	struct HeightField
+	{
+		std::vector<float> Storage;
+		float* Data = nullptr;
+
+		void Allocate(std::size_t count);
+	};
+
+	// How many steps are due after dt more seconds.
+	int StepsDue(float dt);
+
+	// Steps every interior height once.
+	void Step();
+
+	// Marks the tiles the next step solves: the awake ones and their
+	// neighbours, whose edges the awake ones can move.
+	void FindActiveTiles();
+
+	// Puts the active tiles that came to rest to sleep.  After the swap.
+	void SettleTiles();
+
+	// Wakes the tile holding grid point (i, j).
+	void WakeTile(int i, int j);
+
+	// Steps the heights of the active tiles in interior rows [firstRow,
+	// lastRow), which start on a tile row.
+	void SolveRows(int firstRow, int lastRow);
+
+	// Steps columns [firstCol, lastCol) of row i, all in one tile.
+	void SolveSegment(int i, int firstCol, int lastCol);
+
+	// As SolveRows, emitting every row as soon as the rows either side of it
+	// have been stepped.  A row next to another band's rows has to wait for
+	// that band, so it is left for EmitRows once every band is done.
+	void SolveAndEmitRows(int firstRow, int lastRow, Vertex* vertices);
+
+	// Writes rows [firstRow, lastRow) of heights as vertices.
+	void EmitRows(int firstRow, int lastRow, const float* heights, Vertex* vertices)const;
+
+	// How many bands rowCount rows are split into for the thread pool.
+	int BandCount(int rowCount)const;
+
+	// Calls rows(bandFirst, bandLast) for bands covering [firstRow, lastRow).
+	template<typename RowFunc>
+	void ForEachRowBand(int firstRow, int lastRow, RowFunc rows);
+
 private:
     int mNumRows = 0;
     int mNumCols = 0;
@@ -54,10 +150,32 @@ private:
     float mTimeStep = 0.0f;
     float mSpatialStep = 0.0f;
 
-    std::vector<DirectX::XMFLOAT3> mPrevSolution;
-    std::vector<DirectX::XMFLOAT3> mCurrSolution;
-    std::vector<DirectX::XMFLOAT3> mNormals;
-    std::vector<DirectX::XMFLOAT3> mTangentX;
+    // Turns the time passed to Update into whole steps.  Every instance
+    // keeps its own, so separate bodies of water do not share a clock.
+    FixedTimestep mStepClock;
+
+    // Floats between the starts of two rows of a height field.
+    int mRowPitch = 0;
+
+    HeightField mPrevSolution;
+    HeightField mCurrSolution;
+
+    // The x coordinate and texture u of every column.
+    std::vector<float> mColumnX;
+    std::vector<float> mColumnU;
+
+    // Per tile, row by row.  Sleeping tiles are at rest in both time levels.
+    // Active tiles are the ones the current step solves, and TileMax is the
+    // largest height in either time level of an active tile this step.
+    int mTileRows = 0;
+    int mTileCols = 0;
+    std::vector<std::uint8_t> mTileAwake;
+    std::vector<std::uint8_t> mTileActive;
+    std::vector<float> mTileMax;
+    int mActiveTileCount = 0;
+    float mSleepThreshold = 0.0f;
+
+    ThreadPool* mThreadPool = nullptr;
 };
 
 #endif // WAVES_H
\ No newline at end of file
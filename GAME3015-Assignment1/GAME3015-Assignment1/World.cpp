@@ -4,12 +4,12 @@
 #include "World.h"
 
 
-
-const int gNumFrameResources = 3;
-
-World::World(HINSTANCE hInstance)
+World::World(HINSTANCE hInstance, int framesInFlight)
 	: D3DApp(hInstance)
+	, mScene(framesInFlight)
 {
+	// The scene behaves the same at any frame rate.
+	SetFixedTimeStep(1.0f / 60.0f);
 }
 
 World::~World()
@@ -20,10 +20,11 @@ World::~World()
 
 bool World::Initialize()
 {
-	srand((unsigned)time(0));
 	if (!D3DApp::Initialize())
 		return false;
 
+	mRenderDevice = std::make_unique<D3DRenderDevice>(*this);
+
 	// Reset the command list to prep for initialization commands.
 	ThrowIfFailed(mCommandList->Reset(mDirectCmdListAlloc.Get(), nullptr));
 
@@ -31,10 +32,6 @@ bool World::Initialize()
 	// so we have to query this information.
 	mCbvSrvDescriptorSize = md3dDevice->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
 
-	//mCamera.SetPosition(0.8f * scaleFactor, 0.3 * scaleFactor, 1.0f * scaleFactor);
-	mCamera.SetPosition(0, 5, 0 );
-	mCamera.Pitch(3.14/2);
-
 	//Step 1 Load the textures
 	LoadTextures();
 
@@ -44,16 +41,9 @@ bool World::Initialize()
 	BuildDescriptorHeaps();
 	BuildShadersAndInputLayouts();
 
-	// Step 3 Build the geometry for your shapes
-	BuildGroundGeometry();
-
-	// Step 4 Build the material
-	BuildMaterials();
+	// Step 3 Build the geometry, materials, render items and frame resources
+	mScene.Build(*mRenderDevice);
 
-	// Step 5 Build your render items
-	BuildRenderItems();
-
-	BuildFrameResources();
 	BuildPSOs();
 
 
@@ -68,100 +58,65 @@ bool World::Initialize()
 	return true;
 }
 
-void World::OnResize()
+bool World::InitializeHeadless()
 {
-	D3DApp::OnResize();
-	mCamera.SetLens(0.25f*MathHelper::Pi, AspectRatio(), 1.0f, 1000.0f);
-}
+	// No window, device or swap chain; uploads and draws go to memory.
+	mRenderDevice = std::make_unique<NullRenderDevice>(mScene.GetThreadPool().threadCount());
 
-void World::Update(const GameTimer& gt)
-{
-	OnKeyboardInput(gt);
-	//UpdateCamera(gt);
+	mScene.Resize(mClientWidth, mClientHeight);
+	mScene.Build(*mRenderDevice);
 
-	// Cycle through the circular frame resource array.
-	mCurrFrameResourceIndex = (mCurrFrameResourceIndex + 1) % gNumFrameResources;
-	mCurrFrameResource = mFrameResources[mCurrFrameResourceIndex].get();
-
-	// Has the GPU finished processing the commands of the current frame resource?
-	// If not, wait until the GPU has completed commands up to this roof point.
-	if (mCurrFrameResource->Fence != 0 && mFence->GetCompletedValue() < mCurrFrameResource->Fence)
-	{
-		HANDLE eventHandle = CreateEventEx(nullptr, nullptr, false, EVENT_ALL_ACCESS);
-		ThrowIfFailed(mFence->SetEventOnCompletion(mCurrFrameResource->Fence, eventHandle));
-		WaitForSingleObject(eventHandle, INFINITE);
-		CloseHandle(eventHandle);
-	}
-	UpdateObjectCBs(gt);
-	UpdateMaterialCBs(gt);
-	UpdateMainPassCB(gt);
-	UpdateGameObjects(gt);
+	return true;
 }
 
-void World::Draw(const GameTimer& gt)
+RenderDevice& World::GetRenderDevice()
 {
-	auto cmdListAlloc = mCurrFrameResource->CmdListAlloc;
-
-	// Reuse the memory associated with command recording.
-	// We can only reset when the associated command lists have finished execution on the GPU.
-	ThrowIfFailed(cmdListAlloc->Reset());
-
-	// A command list can be reset after it has been added to the command queue via ExecuteCommandList.
-	// Reusing the command list reuses memory.
-	ThrowIfFailed(mCommandList->Reset(cmdListAlloc.Get(), mPSOs["opaque"].Get()));
-
-	mCommandList->RSSetViewports(1, &mScreenViewport);
-	mCommandList->RSSetScissorRects(1, &mScissorRect);
-
-	// Indicate a state transition on the resource usage.
-	mCommandList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(CurrentBackBuffer(),
-		D3D12_RESOURCE_STATE_PRESENT, D3D12_RESOURCE_STATE_RENDER_TARGET));
-
-	// Clear the back buffer and depth buffer.
-	mCommandList->ClearRenderTargetView(CurrentBackBufferView(), (float*)&mMainPassCB.FogColor, 0, nullptr);
-	mCommandList->ClearDepthStencilView(DepthStencilView(), D3D12_CLEAR_FLAG_DEPTH | D3D12_CLEAR_FLAG_STENCIL, 1.0f, 0, 0, nullptr);
-
-	// Specify the buffers we are going to render to.
-	mCommandList->OMSetRenderTargets(1, &CurrentBackBufferView(), true, &DepthStencilView());
-
-	ID3D12DescriptorHeap* descriptorHeaps[] = { mSrvDescriptorHeap.Get() };
-	mCommandList->SetDescriptorHeaps(_countof(descriptorHeaps), descriptorHeaps);
-
-	mCommandList->SetGraphicsRootSignature(mRootSignature.Get());
-
-	auto passCB = mCurrFrameResource->PassCB->Resource();
-	mCommandList->SetGraphicsRootConstantBufferView(2, passCB->GetGPUVirtualAddress());
+	return *mRenderDevice;
+}
 
-	DrawRenderItems(mCommandList.Get(), mRitemLayer[(int)RenderLayer::Opaque]);
+void World::EnableSimulationThread(float stepSeconds)
+{
+	mScene.EnableSimulationThread(stepSeconds);
+}
 
-	mCommandList->SetPipelineState(mPSOs["alphaTested"].Get());
-	DrawRenderItems(mCommandList.Get(), mRitemLayer[(int)RenderLayer::AlphaTested]);
+Scene& World::GetScene()
+{
+	return mScene;
+}
 
-	mCommandList->SetPipelineState(mPSOs["transparent"].Get());
-	DrawRenderItems(mCommandList.Get(), mRitemLayer[(int)RenderLayer::Transparent]);
+void World::UseScriptedInput(bool scripted)
+{
+	mScriptedInput = scripted;
+	mScriptedKeys.fill(false);
+}
 
-	// Indicate a state transition on the resource usage.
-	mCommandList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(CurrentBackBuffer(),
-		D3D12_RESOURCE_STATE_RENDER_TARGET, D3D12_RESOURCE_STATE_PRESENT));
+void World::SetKeyDown(int key, bool down)
+{
+	mScriptedKeys[key & 0xff] = down;
+}
 
-	// Done recording commands.
-	ThrowIfFailed(mCommandList->Close());
+void World::OnResize()
+{
+	D3DApp::OnResize();
+	mScene.Resize(mClientWidth, mClientHeight);
+}
 
-	// Add the command list to the queue for execution.
-	ID3D12CommandList* cmdsLists[] = { mCommandList.Get() };
-	mCommandQueue->ExecuteCommandLists(_countof(cmdsLists), cmdsLists);
+void World::Step(float dt)
+{
+	mScene.Step(dt);
+}
 
-	// Swap the back and front buffers
-	ThrowIfFailed(mSwapChain->Present(0, 0));
-	mCurrBackBuffer = (mCurrBackBuffer + 1) % SwapChainBufferCount;
+void World::Update(const GameTimer& gt)
+{
+	OnKeyboardInput(gt);
+	//UpdateCamera(gt);
 
-	// Advance the roof value to mark commands up to this roof point.
-	mCurrFrameResource->Fence = ++mCurrentFence;
+	mScene.Update(gt.TotalTime(), gt.DeltaTime(), StepAlpha());
+}
 
-	// Add an instruction to the command queue to set a new roof point. 
-	// Because we are on the GPU timeline, the new roof point won't be 
-	// set until the GPU finishes processing all the commands prior to this Signal().
-	mCommandQueue->Signal(mFence.Get(), mCurrentFence);
+void World::Draw(const GameTimer& gt)
+{
+	mScene.Draw();
 }
 
 void World::OnMouseDown(WPARAM btnState, int x, int y)
@@ -185,8 +140,8 @@ void World::OnMouseMove(WPARAM btnState, int x, int y)
 		float dx = XMConvertToRadians(0.25f * static_cast<float>(x - mLastMousePos.x));
 		float dy = XMConvertToRadians(0.25f * static_cast<float>(y - mLastMousePos.y));
 
-		mCamera.Pitch(dy);
-		mCamera.RotateY(dx);
+		mScene.GetCamera().Pitch(dy);
+		mScene.GetCamera().RotateY(dx);
 	}
 	mLastMousePos.x = x;
 	mLastMousePos.y = y;
@@ -197,145 +152,59 @@ void World::OnKeyboardInput(const GameTimer& gt)
 
 	const float dt = gt.DeltaTime();
 
-	mCamera.GetLook();
+	Camera& camera = mScene.GetCamera();
+	camera.GetLook();
 	float tmin = 0;
 	float buffer = 0.5 ;
 	XMFLOAT3  oppositef3(-1, -1, -1);
 	XMVECTOR opposite = XMLoadFloat3(&oppositef3);
 
-	if (GetAsyncKeyState('W') & 0x8000)
+	if (IsKeyDown('W'))
 	{
 		bool hit = false;
 		
 		if (!hit)
 		{
-				mCamera.Walk(10.0f*dt);
+				camera.Walk(10.0f*dt);
 			
 		}
 	}
 
-	if (GetAsyncKeyState('S') & 0x8000)
+	if (IsKeyDown('S'))
 	{
 		bool hit = false;
 		if (!hit)
 		{
-			mCamera.Walk(-10.0f*dt);
+			camera.Walk(-10.0f*dt);
 		}
 		
 	}
-	if (GetAsyncKeyState('A') & 0x8000)
+	if (IsKeyDown('A'))
 	{
 		bool hit = false;
 		if (!hit)
 		{
-			mCamera.Strafe(-10.0f*dt);
+			camera.Strafe(-10.0f*dt);
 		}
 		
 		
 	}
-	if (GetAsyncKeyState('D') & 0x8000)
+	if (IsKeyDown('D'))
 	{
 		bool hit = false;
 		if (!hit)
 		{
-			mCamera.Strafe(10.0f*dt);
+			camera.Strafe(10.0f*dt);
 		}
 	}
-		
-
-	mCamera.UpdateViewMatrix();
 }
 
-void World::UpdateObjectCBs(const GameTimer& gt)
+bool World::IsKeyDown(int key) const
 {
-	auto currObjectCB = mCurrFrameResource->ObjectCB.get();
-	for (auto& e : mAllRitems)
-	{
-		// Only update the cbuffer data if the constants have changed.  
-		// This needs to be tracked per frame resource.
-		if (e->NumFramesDirty > 0)
-		{
-			XMMATRIX world = XMLoadFloat4x4(&e->World);
-			XMMATRIX texTransform = XMLoadFloat4x4(&e->TexTransform);
+	if (mScriptedInput)
+		return mScriptedKeys[key & 0xff];
 
-			ObjectConstants objConstants;
-			XMStoreFloat4x4(&objConstants.World, XMMatrixTranspose(world));
-			XMStoreFloat4x4(&objConstants.TexTransform, XMMatrixTranspose(texTransform));
-
-			currObjectCB->CopyData(e->ObjCBIndex, objConstants);
-
-			// Next FrameResource need to be updated too.
-			e->NumFramesDirty--;
-		}
-	}
-}
-
-void World::UpdateMaterialCBs(const GameTimer& gt)
-{
-	auto currMaterialCB = mCurrFrameResource->MaterialCB.get();
-	for (auto& e : mMaterials)
-	{
-		// Only update the cbuffer data if the constants have changed.  If the cbuffer
-		// data changes, it needs to be updated for each FrameResource.
-		Material* mat = e.second.get();
-		if (mat->NumFramesDirty > 0)
-		{
-			XMMATRIX matTransform = XMLoadFloat4x4(&mat->MatTransform);
-
-			MaterialConstants matConstants;
-			matConstants.DiffuseAlbedo = mat->DiffuseAlbedo;
-			matConstants.FresnelR0 = mat->FresnelR0;
-			matConstants.Roughness = mat->Roughness;
-			XMStoreFloat4x4(&matConstants.MatTransform, XMMatrixTranspose(matTransform));
-
-			currMaterialCB->CopyData(mat->MatCBIndex, matConstants);
-
-			// Next FrameResource need to be updated too.
-			mat->NumFramesDirty--;
-		}
-	}
-}
-
-void World::UpdateMainPassCB(const GameTimer& gt)
-{
-	XMMATRIX view = mCamera.GetView();
-	XMMATRIX proj = mCamera.GetProj();
-
-	XMMATRIX viewProj = XMMatrixMultiply(view, proj);
-	XMMATRIX invView = XMMatrixInverse(&XMMatrixDeterminant(view), view);
-	XMMATRIX invProj = XMMatrixInverse(&XMMatrixDeterminant(proj), proj);
-	XMMATRIX invViewProj = XMMatrixInverse(&XMMatrixDeterminant(viewProj), viewProj);
-
-	XMStoreFloat4x4(&mMainPassCB.View, XMMatrixTranspose(view));
-	XMStoreFloat4x4(&mMainPassCB.InvView, XMMatrixTranspose(invView));
-	XMStoreFloat4x4(&mMainPassCB.Proj, XMMatrixTranspose(proj));
-	XMStoreFloat4x4(&mMainPassCB.InvProj, XMMatrixTranspose(invProj));
-	XMStoreFloat4x4(&mMainPassCB.ViewProj, XMMatrixTranspose(viewProj));
-	XMStoreFloat4x4(&mMainPassCB.InvViewProj, XMMatrixTranspose(invViewProj));
-	mMainPassCB.EyePosW = mCamera.GetPosition3f();
-	mMainPassCB.RenderTargetSize = XMFLOAT2((float)mClientWidth, (float)mClientHeight);
-	mMainPassCB.InvRenderTargetSize = XMFLOAT2(1.0f / mClientWidth, 1.0f / mClientHeight);
-	mMainPassCB.NearZ = 1.0f;
-	mMainPassCB.FarZ = 1000.0f;
-	mMainPassCB.TotalTime = gt.TotalTime();
-	mMainPassCB.DeltaTime = gt.DeltaTime();
-	mMainPassCB.AmbientLight = { 0.25f, 0.25f, 0.35f, 1.0f };
-	mMainPassCB.Lights[0].Direction = { 0.57735f, -0.57735f, 0.57735f };
-	mMainPassCB.Lights[0].Strength = { 0.6f, 0.6f, 0.6f };
-	mMainPassCB.Lights[1].Direction = { -0.57735f, -0.57735f, 0.57735f };
-	mMainPassCB.Lights[1].Strength = { 0.3f, 0.3f, 0.3f };
-	mMainPassCB.Lights[2].Direction = { 0.0f, -0.707f, -0.707f };
-	mMainPassCB.Lights[2].Strength = { 0.15f, 0.15f, 0.15f };
-	mMainPassCB.Lights[3].Position = { -5.0f  , 3.0f , 0.0f  };
-	mMainPassCB.Lights[3].Strength = { 1.0f, 0.0f, 0.0f };
-	mMainPassCB.Lights[3].Direction = { 0.0, -1.0, 0.0f };
-	mMainPassCB.Lights[3].FalloffStart = { 1.0f   };
-	mMainPassCB.Lights[3].FalloffEnd = { 5.0f  };
-	mMainPassCB.Lights[3].SpotPower = { 1.0f };
-
-
-	auto currPassCB = mCurrFrameResource->PassCB.get();
-	currPassCB->CopyData(0, mMainPassCB);
+	return (GetAsyncKeyState(key) & 0x8000) != 0;
 }
 
 void World::LoadTextures()
@@ -374,18 +243,20 @@ void World::BuildRootSignature()
 	texTable.Init(D3D12_DESCRIPTOR_RANGE_TYPE_SRV, 1, 0);
 
 	// Root parameter can be a table, root descriptor or root constants.
-	CD3DX12_ROOT_PARAMETER slotRootParameter[4];
+	CD3DX12_ROOT_PARAMETER slotRootParameter[6];
 
 	// Perfomance TIP: Order from most frequent to least frequent.
 	slotRootParameter[0].InitAsDescriptorTable(1, &texTable, D3D12_SHADER_VISIBILITY_PIXEL);
-	slotRootParameter[1].InitAsConstantBufferView(0);
+	slotRootParameter[1].InitAsConstants(1, 0);
 	slotRootParameter[2].InitAsConstantBufferView(1);
 	slotRootParameter[3].InitAsConstantBufferView(2);
+	slotRootParameter[4].InitAsShaderResourceView(0, 1);
+	slotRootParameter[5].InitAsShaderResourceView(1, 1);
 
 	auto staticSamplers = GetStaticSamplers();
 
 	// A root signature is an array of root parameters.
-	CD3DX12_ROOT_SIGNATURE_DESC rootSigDesc(4, slotRootParameter,
+	CD3DX12_ROOT_SIGNATURE_DESC rootSigDesc(6, slotRootParameter,
 		(UINT)staticSamplers.size(), staticSamplers.data(),
 		D3D12_ROOT_SIGNATURE_FLAG_ALLOW_INPUT_ASSEMBLER_INPUT_LAYOUT);
 
@@ -477,87 +348,6 @@ void World::BuildShadersAndInputLayouts()
 
 }
 
-void World::UpdateGameObjects(const GameTimer& gt)
-{
-	if (XMVectorGetX(mPlane->mPosition) > 1.8 || XMVectorGetX(mPlane->mPosition) < -1.8)
-	{
-		mPlane->mVelocity *= -1;
-		leftPlane->mVelocity *= -1;
-		rightPlane->mVelocity *= -1;
-	}
-
-	if (XMVectorGetZ(background.mPosition) < -12)
-	{
-		background.mPosition = { XMVectorGetX(background.mPosition) , XMVectorGetY(background.mPosition) , 12 };
-	}
-
-	if (XMVectorGetZ(background2.mPosition) < -12)
-	{
-		background2.mPosition = { XMVectorGetX(background2.mPosition) , XMVectorGetY(background2.mPosition) , 12 };
-	}
-
-	mPlane->update(gt, mAllRitems);
-	leftPlane->update(gt, mAllRitems);
-	rightPlane->update(gt, mAllRitems);
-	background.update(gt, mAllRitems);
-	background2.update(gt, mAllRitems);
-
-	// Apply movements
-	mSceneGraph.update(gt, mAllRitems);
-}
-
-void World::BuildGroundGeometry()
-{
-	GeometryGenerator geoGen;
-	GeometryGenerator::MeshData ground = geoGen.CreateBox(20, 0.2, 20, 1);
-
-
-	std::vector<Vertex> vertices(ground.Vertices.size());
-	for (size_t i = 0; i < ground.Vertices.size(); ++i)
-	{
-		auto& p = ground.Vertices[i].Position;
-		vertices[i].Pos = p;
-		vertices[i].Normal = ground.Vertices[i].Normal;
-		vertices[i].TexC = ground.Vertices[i].TexC;
-	}
-
-	const UINT vbByteSize = (UINT)vertices.size() * sizeof(Vertex);
-
-	std::vector<std::uint16_t> indices = ground.GetIndices16();
-	const UINT ibByteSize = (UINT)indices.size() * sizeof(std::uint16_t);
-
-	auto geo = std::make_unique<MeshGeometry>();
-	geo->Name = "groundGeo";
-
-	ThrowIfFailed(D3DCreateBlob(vbByteSize, &geo->VertexBufferCPU));
-	CopyMemory(geo->VertexBufferCPU->GetBufferPointer(), vertices.data(), vbByteSize);
-
-	ThrowIfFailed(D3DCreateBlob(ibByteSize, &geo->IndexBufferCPU));
-	CopyMemory(geo->IndexBufferCPU->GetBufferPointer(), indices.data(), ibByteSize);
-
-	geo->VertexBufferGPU = d3dUtil::CreateDefaultBuffer(md3dDevice.Get(),
-		mCommandList.Get(), vertices.data(), vbByteSize, geo->VertexBufferUploader);
-
-	geo->IndexBufferGPU = d3dUtil::CreateDefaultBuffer(md3dDevice.Get(),
-		mCommandList.Get(), indices.data(), ibByteSize, geo->IndexBufferUploader);
-
-	geo->VertexByteStride = sizeof(Vertex);
-	geo->VertexBufferByteSize = vbByteSize;
-	geo->IndexFormat = DXGI_FORMAT_R16_UINT;
-	geo->IndexBufferByteSize = ibByteSize;
-
-	SubmeshGeometry submesh;
-	submesh.IndexCount = (UINT)indices.size();
-	submesh.StartIndexLocation = 0;
-	submesh.BaseVertexLocation = 0;
-	
-	geo->DrawArgs["ground"] = submesh;
-
-	mGeometries[geo->Name] = std::move(geo);
-}
-
-
-
 void World::BuildPSOs()
 {
 	D3D12_GRAPHICS_PIPELINE_STATE_DESC opaquePsoDesc;
@@ -630,208 +420,358 @@ void World::BuildPSOs()
 	};
 	alphaTestedPsoDesc.RasterizerState.CullMode = D3D12_CULL_MODE_NONE;
 	ThrowIfFailed(md3dDevice->CreateGraphicsPipelineState(&alphaTestedPsoDesc, IID_PPV_ARGS(&mPSOs["alphaTested"])));
-}
 
-void World::BuildFrameResources()
-{
-	for (int i = 0; i < gNumFrameResources; ++i)
+	// The scene names its pipelines; the draws refer to them by handle.
+	const ResourceRegistry<RenderLayer, PsoHandle>& psoTable = mScene.GetPsoTable();
+	mPipelineStates.resize(psoTable.size());
+	for (std::uint32_t i = 0; i < psoTable.size(); ++i)
 	{
-		mFrameResources.push_back(std::make_unique<FrameResource>(md3dDevice.Get(),
-			1, (UINT)mAllRitems.size(), (UINT)mMaterials.size()));
+		PsoHandle handle;
+		handle.Index = i;
+		mPipelineStates[i] = mPSOs[psoTable.name(handle)].Get();
 	}
 }
 
-void World::BuildMaterials()
+World::D3DCommandList::D3DCommandList(World& world, ID3D12GraphicsCommandList* cmdList)
+	: mWorld(world)
+	, mCmdList(cmdList)
+	, mMaterialCBAddress(world.mCurrFrameResource->MaterialCB->Resource()->GetGPUVirtualAddress())
+	, mMatCBByteSize(d3dUtil::CalcConstantBufferByteSize(sizeof(MaterialConstants)))
 {
-	//GameWorld.buildMaterials(mMaterials);
+}
 
-	int matIndex = 0;
-	auto BackgroundTex = std::make_unique<Material>();
-	BackgroundTex->Name = "BackgroundTex";
-	BackgroundTex->MatCBIndex = matIndex;
-	BackgroundTex->DiffuseSrvHeapIndex = matIndex++;
-	BackgroundTex->DiffuseAlbedo = XMFLOAT4(1.0f, 1.0f, 1.0f, 1.0f);
-	BackgroundTex->FresnelR0 = XMFLOAT3(0.01f, 0.01f, 0.01f);
-	BackgroundTex->Roughness = 0.125f;
+World::D3DRenderDevice::D3DRenderDevice(World& world)
+	: mWorld(world)
+	, mRecorder(world)
+	, mFence(world)
+{
+}
 
-	
+void World::D3DRenderDevice::createMeshBuffers(MeshHandle mesh, const void* vertices, std::uint32_t vertexBytes,
+	std::uint32_t vertexStride, const void* indices, std::uint32_t indexBytes)
+{
+	auto geo = std::make_unique<MeshGeometry>();
 
-	auto Eagle = std::make_unique<Material>();
-	Eagle->Name = "Eagle";
-	Eagle->MatCBIndex = matIndex;
-	Eagle->DiffuseSrvHeapIndex = matIndex++;
-	Eagle->DiffuseAlbedo = XMFLOAT4(1.0f, 1.0f, 1.0f, 1.0f);
-	Eagle->FresnelR0 = XMFLOAT3(0.02f, 0.02f, 0.02f);
-	Eagle->Roughness = 0.25f;
-
-	auto Raptor = std::make_unique<Material>();
-	Raptor->Name = "Raptor";
-	Raptor->MatCBIndex = matIndex;
-	Raptor->DiffuseSrvHeapIndex = matIndex++;
-	Raptor->DiffuseAlbedo = XMFLOAT4(1.0f, 1.0f, 1.0f, 1.0f);
-	Raptor->FresnelR0 = XMFLOAT3(0.01f, 0.01f, 0.01f);
-	Raptor->Roughness = 0.125f;
+	ThrowIfFailed(D3DCreateBlob(vertexBytes, &geo->VertexBufferCPU));
+	CopyMemory(geo->VertexBufferCPU->GetBufferPointer(), vertices, vertexBytes);
 
-	
+	ThrowIfFailed(D3DCreateBlob(indexBytes, &geo->IndexBufferCPU));
+	CopyMemory(geo->IndexBufferCPU->GetBufferPointer(), indices, indexBytes);
 
-	mMaterials["BackgroundTex"] = std::move(BackgroundTex);
-	mMaterials["EagleTex"] = std::move(Eagle);
-	mMaterials["RaptorTex"] = std::move(Raptor);
-	
+	geo->VertexBufferGPU = d3dUtil::CreateDefaultBuffer(mWorld.md3dDevice.Get(),
+		mWorld.mCommandList.Get(), vertices, vertexBytes, geo->VertexBufferUploader);
+
+	geo->IndexBufferGPU = d3dUtil::CreateDefaultBuffer(mWorld.md3dDevice.Get(),
+		mWorld.mCommandList.Get(), indices, indexBytes, geo->IndexBufferUploader);
 
+	geo->VertexByteStride = vertexStride;
+	geo->VertexBufferByteSize = vertexBytes;
+	geo->IndexFormat = DXGI_FORMAT_R16_UINT;
+	geo->IndexBufferByteSize = indexBytes;
+
+	if (mWorld.mGeometries.size() <= mesh.Index)
+		mWorld.mGeometries.resize(mesh.Index + 1);
+	mWorld.mGeometries[mesh.Index] = std::move(geo);
 }
 
+void World::D3DRenderDevice::createFrameResources(int count, std::uint32_t objectCount, std::uint32_t materialCount)
+{
+	auto& frameResources = mWorld.mFrameResources;
+	for (int i = 0; i < count; ++i)
+	{
+		frameResources.push_back(std::make_unique<FrameResource>(mWorld.md3dDevice.Get(),
+			1, objectCount, materialCount));
 
-void World::BuildRenderItems()
+		// One draw recording list per thread that can record.
+		frameResources.back()->CreateWorkerCommandLists(mWorld.md3dDevice.Get(), mWorld.mScene.GetThreadPool().threadCount());
+	}
+
+	mFence.createWaitObjects(count);
+
+	ThrowIfFailed(mWorld.md3dDevice->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_DIRECT,
+		frameResources[0]->CmdListAlloc.Get(), nullptr, IID_PPV_ARGS(mPostCommandList.GetAddressOf())));
+	ThrowIfFailed(mPostCommandList->Close());
+}
+
+FrameFence& World::D3DRenderDevice::fence()
 {
-	UINT objCBIndex = 0;
+	return mFence;
+}
 
-	// Initialize the different layers
-	for (std::size_t i = 0; i < LayerCount; ++i)
-	{
-		SceneNode::Ptr layer(new SceneNode());
-		mSceneLayers[i] = layer.get();
+void World::D3DRenderDevice::beginFrame(int frameResource)
+{
+	FrameResource* frame = mWorld.mFrameResources[frameResource].get();
+	mWorld.mCurrFrameResource = frame;
 
-		mSceneGraph.attachChild(std::move(layer));
+	// Nothing handed out for this frame resource last time round is in use any more.
+	frame->FrameData->reset();
+
+	mRecorder.rebind();
+}
+
+bool World::D3DRenderDevice::reserveObjects(std::uint32_t count)
+{
+	return mWorld.mCurrFrameResource->ReserveObjects(mWorld.md3dDevice.Get(), count);
+}
+
+void World::D3DRenderDevice::upload(FrameBuffer buffer, std::uint32_t element, const void* data, std::size_t size)
+{
+	FrameResource* frame = mWorld.mCurrFrameResource;
+	switch (buffer)
+	{
+	case FrameBuffer::MaterialConstants:
+		assert(size == sizeof(MaterialConstants));
+		frame->MaterialCB->CopyData(element, *static_cast<const MaterialConstants*>(data));
+		break;
+
+	case FrameBuffer::ObjectData:
+		assert(size == sizeof(ObjectConstants));
+		frame->ObjectData->CopyData(element, *static_cast<const ObjectConstants*>(data));
+		break;
+
+	default:
+		assert(false);
+		break;
 	}
+}
+
+void World::D3DRenderDevice::uploadObjects(const ObjectTransforms& objects, ObjectTransforms::HandleRange handles, float alpha)
+{
+	static_assert(sizeof(ObjectConstants) == 2 * sizeof(XMFLOAT4X4), "streamConstants writes ObjectConstants");
+
+	UploadBuffer<ObjectConstants>& objectData = *mWorld.mCurrFrameResource->ObjectData;
+	objects.streamConstants(handles, objectData.MappedData(), objectData.ElementByteSize(), alpha);
+}
+
+void World::D3DRenderDevice::uploadFrameData(FrameBuffer buffer, const void* data, std::size_t size)
+{
+	FrameResource* frame = mWorld.mCurrFrameResource;
+
+	UploadAllocator::Allocation allocation = frame->FrameData->allocate(size);
+	memcpy(allocation.CpuAddress, data, size);
 
-	background.renderItem = std::make_unique<RenderItem>();
-	XMStoreFloat4x4(&background.renderItem->World, XMMatrixScaling(1.0f, 1.0f, 1.0f) * XMMatrixTranslation(0.0f, 0, 0));/// can choose your scaling here
-	XMStoreFloat4x4(&background.renderItem->TexTransform, XMMatrixScaling(10.0f, 10.0f, 10.0f));
-	XMVECTOR spawnpointBackground = { 0, 0, 0 };
-	background.mPosition = spawnpointBackground;
-	background.mVelocity = { 0.0f, 0.0f, -0.5f };
-	background.Scale = { 1.0f, 1.0f, 1.0f };
-	background.renderItem->ObjCBIndex = objCBIndex++;
-	background.renderItem->Mat = mMaterials["BackgroundTex"].get();
-	background.renderItem->Geo = mGeometries["groundGeo"].get();
-	background.renderItem->PrimitiveType = D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST;
-	background.renderItem->IndexCount = background.renderItem->Geo->DrawArgs["ground"].IndexCount;
-	background.renderItem->StartIndexLocation = background.renderItem->Geo->DrawArgs["ground"].StartIndexLocation;
-	background.renderItem->BaseVertexLocation = background.renderItem->Geo->DrawArgs["ground"].BaseVertexLocation;
-
-	mRitemLayer[(int)RenderLayer::Opaque].push_back(background.renderItem.get());
-	mAllRitems.push_back(std::move(background.renderItem));
-	background.renderIndex = mAllRitems.size() - 1;
-
-	background2.renderItem = std::make_unique<RenderItem>();
-	XMStoreFloat4x4(&background2.renderItem->World, XMMatrixScaling(1.0f, 1.0f, 1.0f) * XMMatrixTranslation(0.0f, 0, 12));/// can choose your scaling here
-	XMStoreFloat4x4(&background2.renderItem->TexTransform, XMMatrixScaling(10.0f, 10.0f, 10.0f));
-	XMVECTOR spawnpointbackground2 = { 0, 0, 12 };
-	background2.mPosition = spawnpointbackground2;
-	background2.mVelocity = { 0.0f, 0.0f, -0.5f };
-	background2.Scale = { 1.0f, 1.0f, 1.0f };
-	background2.renderItem->ObjCBIndex = objCBIndex++;
-	background2.renderItem->Mat = mMaterials["BackgroundTex"].get();
-	background2.renderItem->Geo = mGeometries["groundGeo"].get();
-	background2.renderItem->PrimitiveType = D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST;
-	background2.renderItem->IndexCount = background2.renderItem->Geo->DrawArgs["ground"].IndexCount;
-	background2.renderItem->StartIndexLocation = background2.renderItem->Geo->DrawArgs["ground"].StartIndexLocation;
-	background2.renderItem->BaseVertexLocation = background2.renderItem->Geo->DrawArgs["ground"].BaseVertexLocation;
-
-	mRitemLayer[(int)RenderLayer::Opaque].push_back(background2.renderItem.get());
-	mAllRitems.push_back(std::move(background2.renderItem));
-	background2.renderIndex = mAllRitems.size() - 1;
-
-	//make the main plane
-	mPlane = new Aircraft(Aircraft::Raptor);
-	mPlane->renderItem = std::make_unique<RenderItem>();
-	XMStoreFloat4x4(&mPlane->renderItem->World, XMMatrixScaling(0.01f, 0.01f, 0.01f) * XMMatrixTranslation(-1.0f, 1, -1));/// can choose your scaling here
-	XMVECTOR spawnpoint = { -1.0f , 1 , -1 };
-	mPlane->mPosition = spawnpoint;
-	mPlane->mVelocity = { 0.5f, 0.0f, 0.0f };
-	mPlane->Scale = { 0.01f, 0.01f, 0.01f };
-	//XMStorevector(&mPlane->position, spawnpoint);
-	XMStoreFloat4x4(&mPlane->renderItem->TexTransform, XMMatrixScaling(1.0f, 1.0f, 1.0f));
-	mPlane->renderItem->ObjCBIndex = objCBIndex++;
-	mPlane->renderItem->Mat = mMaterials["RaptorTex"].get();
-	mPlane->renderItem->Geo = mGeometries["groundGeo"].get();
-	mPlane->renderItem->PrimitiveType = D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST;
-	mPlane->renderItem->IndexCount = mPlane->renderItem->Geo->DrawArgs["ground"].IndexCount;
-	mPlane->renderItem->StartIndexLocation = mPlane->renderItem->Geo->DrawArgs["ground"].StartIndexLocation;
-	mPlane->renderItem->BaseVertexLocation = mPlane->renderItem->Geo->DrawArgs["ground"].BaseVertexLocation;
-
-	mRitemLayer[(int)RenderLayer::AlphaTested].push_back(mPlane->renderItem.get());
-	mAllRitems.push_back(std::move(mPlane->renderItem));
-	mPlane->renderIndex = mAllRitems.size() - 1;
-
-	//make the left plane
-	leftPlane = new Aircraft(Aircraft::Eagle);
-	leftPlane->renderItem = std::make_unique<RenderItem>();
-	XMStoreFloat4x4(&leftPlane->renderItem->World, XMMatrixScaling(0.01f, 0.01f, 0.01f) * XMMatrixTranslation(-1.25f, 1, -1.25));/// can choose your scaling here
-	spawnpoint = { -1.25f , 1.0f , -1.25f };
-	leftPlane->mPosition = spawnpoint;
-	leftPlane->mVelocity = { 0.5f, 0.0f, 0.0f };
-	leftPlane->Scale = { 0.01f, 0.01f, 0.01f };
-	XMStoreFloat4x4(&leftPlane->renderItem->TexTransform, XMMatrixScaling(1.0f, 1.0f, 1.0f));
-	leftPlane->renderItem->ObjCBIndex = objCBIndex++;
-	leftPlane->renderItem->Mat = mMaterials["EagleTex"].get();
-	leftPlane->renderItem->Geo = mGeometries["groundGeo"].get();
-	leftPlane->renderItem->PrimitiveType = D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST;
-	leftPlane->renderItem->IndexCount = leftPlane->renderItem->Geo->DrawArgs["ground"].IndexCount;
-	leftPlane->renderItem->StartIndexLocation = leftPlane->renderItem->Geo->DrawArgs["ground"].StartIndexLocation;
-	leftPlane->renderItem->BaseVertexLocation = leftPlane->renderItem->Geo->DrawArgs["ground"].BaseVertexLocation;
-
-	mRitemLayer[(int)RenderLayer::AlphaTested].push_back(leftPlane->renderItem.get());
-	mAllRitems.push_back(std::move(leftPlane->renderItem));
-	leftPlane->renderIndex = mAllRitems.size() - 1;
-
-
-	//make the right plane
-	rightPlane = new Aircraft(Aircraft::Eagle);
-	rightPlane->renderItem = std::make_unique<RenderItem>();
-	XMStoreFloat4x4(&rightPlane->renderItem->World, XMMatrixScaling(0.01f, 0.01f, 0.01f) * XMMatrixTranslation(-0.75f, 1, -1.25));/// can choose your scaling here
-	spawnpoint = { -0.75f , 1.0f , -1.25f };
-	rightPlane->mPosition = spawnpoint;
-	rightPlane->mVelocity = { 0.5f, 0.0f, 0.0f };
-	rightPlane->Scale = { 0.01f, 0.01f, 0.01f };
-	XMStoreFloat4x4(&rightPlane->renderItem->TexTransform, XMMatrixScaling(1.0f, 1.0f, 1.0f));
-	rightPlane->renderItem->ObjCBIndex = objCBIndex++;
-	rightPlane->renderItem->Mat = mMaterials["EagleTex"].get();
-	rightPlane->renderItem->Geo = mGeometries["groundGeo"].get();
-	rightPlane->renderItem->PrimitiveType = D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST;
-	rightPlane->renderItem->IndexCount = rightPlane->renderItem->Geo->DrawArgs["ground"].IndexCount;
-	rightPlane->renderItem->StartIndexLocation = rightPlane->renderItem->Geo->DrawArgs["ground"].StartIndexLocation;
-	rightPlane->renderItem->BaseVertexLocation = rightPlane->renderItem->Geo->DrawArgs["ground"].BaseVertexLocation;
-
-	mRitemLayer[(int)RenderLayer::AlphaTested].push_back(rightPlane->renderItem.get());
-	mAllRitems.push_back(std::move(rightPlane->renderItem));
-	rightPlane->renderIndex = mAllRitems.size() - 1;
-
-}
-
-void World::DrawRenderItems(ID3D12GraphicsCommandList* cmdList, const std::vector<RenderItem*>& ritems)
-{
-	UINT objCBByteSize = d3dUtil::CalcConstantBufferByteSize(sizeof(ObjectConstants));
-	UINT matCBByteSize = d3dUtil::CalcConstantBufferByteSize(sizeof(MaterialConstants));
-
-	auto objectCB = mCurrFrameResource->ObjectCB->Resource();
-	auto matCB = mCurrFrameResource->MaterialCB->Resource();
-
-	// For each render item...
-	for (size_t i = 0; i < ritems.size(); ++i)
+	switch (buffer)
 	{
-		auto ri = ritems[i];
+	case FrameBuffer::PassConstants:
+		assert(size == sizeof(PassConstants));
+		frame->PassCBAddress = allocation.GpuAddress;
+		break;
+
+	case FrameBuffer::InstanceIndices:
+		frame->InstanceIndicesAddress = allocation.GpuAddress;
+		break;
+
+	default:
+		assert(false);
+		break;
+	}
+}
 
-		cmdList->IASetVertexBuffers(0, 1, &ri->Geo->VertexBufferView());
-		cmdList->IASetIndexBuffer(&ri->Geo->IndexBufferView());
-		//
-		cmdList->IASetPrimitiveTopology(ri->PrimitiveType);
+void World::D3DRenderDevice::clear(const float color[4])
+{
+	auto cmdListAlloc = mWorld.mCurrFrameResource->CmdListAlloc;
+	auto cmdList = mWorld.mCommandList;
 
-		CD3DX12_GPU_DESCRIPTOR_HANDLE tex(mSrvDescriptorHeap->GetGPUDescriptorHandleForHeapStart());
-		tex.Offset(ri->Mat->DiffuseSrvHeapIndex, mCbvSrvDescriptorSize);
+	// Reuse the memory associated with command recording.
+	// We can only reset when the associated command lists have finished execution on the GPU.
+	ThrowIfFailed(cmdListAlloc->Reset());
+
+	// A command list can be reset after it has been added to the command queue via ExecuteCommandList.
+	// Reusing the command list reuses memory.
+	ThrowIfFailed(cmdList->Reset(cmdListAlloc.Get(), nullptr));
+
+	cmdList->RSSetViewports(1, &mWorld.mScreenViewport);
+	cmdList->RSSetScissorRects(1, &mWorld.mScissorRect);
+
+	// Indicate a state transition on the resource usage.
+	cmdList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(mWorld.CurrentBackBuffer(),
+		D3D12_RESOURCE_STATE_PRESENT, D3D12_RESOURCE_STATE_RENDER_TARGET));
+
+	// Clear the back buffer and depth buffer.
+	cmdList->ClearRenderTargetView(mWorld.CurrentBackBufferView(), color, 0, nullptr);
+	cmdList->ClearDepthStencilView(mWorld.DepthStencilView(), D3D12_CLEAR_FLAG_DEPTH | D3D12_CLEAR_FLAG_STENCIL, 1.0f, 0, 0, nullptr);
+
+	// Done recording the clear; the draws go into the worker lists.
+	ThrowIfFailed(cmdList->Close());
+}
 
-		D3D12_GPU_VIRTUAL_ADDRESS objCBAddress = objectCB->GetGPUVirtualAddress() + ri->ObjCBIndex * objCBByteSize;
-		D3D12_GPU_VIRTUAL_ADDRESS matCBAddress = matCB->GetGPUVirtualAddress() + ri->Mat->MatCBIndex * matCBByteSize;
+CommandRecorder& World::D3DRenderDevice::recorder()
+{
+	return mRecorder;
+}
+
+void World::D3DRenderDevice::endFrame(unsigned listCount)
+{
+	FrameResource* frame = mWorld.mCurrFrameResource;
+
+	// The lists from one frame resource's allocator are recorded one after the
+	// other, so the closing barrier can share the allocator of the clear.
+	ThrowIfFailed(mPostCommandList->Reset(frame->CmdListAlloc.Get(), nullptr));
+
+	// Indicate a state transition on the resource usage.
+	mPostCommandList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(mWorld.CurrentBackBuffer(),
+		D3D12_RESOURCE_STATE_RENDER_TARGET, D3D12_RESOURCE_STATE_PRESENT));
+
+	// Done recording commands.
+	ThrowIfFailed(mPostCommandList->Close());
+
+	// Add the command lists to the queue for execution, in draw order.
+	mSubmitLists.clear();
+	mSubmitLists.push_back(mWorld.mCommandList.Get());
+	for (unsigned i = 0; i < listCount; ++i)
+		mSubmitLists.push_back(frame->WorkerCmdLists[i].Get());
+	mSubmitLists.push_back(mPostCommandList.Get());
+	mWorld.mCommandQueue->ExecuteCommandLists((UINT)mSubmitLists.size(), mSubmitLists.data());
+
+	// Swap the back and front buffers
+	ThrowIfFailed(mWorld.mSwapChain->Present(0, 0));
+	mWorld.mCurrBackBuffer = (mWorld.mCurrBackBuffer + 1) % SwapChainBufferCount;
+}
+
+World::D3DFence::D3DFence(World& world)
+	: mWorld(world)
+{
+}
 
-		cmdList->SetGraphicsRootDescriptorTable(0, tex);
-		cmdList->SetGraphicsRootConstantBufferView(1, objCBAddress);
-		cmdList->SetGraphicsRootConstantBufferView(3, matCBAddress);
+World::D3DFence::~D3DFence()
+{
+	for (HANDLE eventHandle : mEvents)
+		CloseHandle(eventHandle);
+}
 
-		cmdList->DrawIndexedInstanced(ri->IndexCount, 1, ri->StartIndexLocation, ri->BaseVertexLocation, 0);
+void World::D3DFence::createWaitObjects(int count)
+{
+	// Created once and reused for every wait on the frame resource.
+	while ((int)mEvents.size() < count)
+	{
+		HANDLE eventHandle = CreateEventEx(nullptr, nullptr, false, EVENT_ALL_ACCESS);
+		if (eventHandle == nullptr)
+			ThrowIfFailed(HRESULT_FROM_WIN32(GetLastError()));
+		mEvents.push_back(eventHandle);
 	}
 }
 
+std::uint64_t World::D3DFence::completedValue() const
+{
+	return mWorld.mFence->GetCompletedValue();
+}
+
+void World::D3DFence::wait(int slot, std::uint64_t value)
+{
+	// Fire event when GPU hits the roof value, then wait for it.
+	ThrowIfFailed(mWorld.mFence->SetEventOnCompletion(value, mEvents[slot]));
+	WaitForSingleObject(mEvents[slot], INFINITE);
+}
+
+std::uint64_t World::D3DFence::signal()
+{
+	// Advance the roof value to mark commands up to this roof point.
+	++mWorld.mCurrentFence;
+
+	// Add an instruction to the command queue to set a new roof point. 
+	// Because we are on the GPU timeline, the new roof point won't be 
+	// set until the GPU finishes processing all the commands prior to this Signal().
+	ThrowIfFailed(mWorld.mCommandQueue->Signal(mWorld.mFence.Get(), mWorld.mCurrentFence));
+	return mWorld.mCurrentFence;
+}
+
+World::D3DCommandRecorder::D3DCommandRecorder(World& world)
+	: mWorld(world)
+{
+}
+
+void World::D3DCommandRecorder::rebind()
+{
+	FrameResource* frame = mWorld.mCurrFrameResource;
+
+	mCommandLists.clear();
+	mCommandLists.reserve(frame->WorkerCmdLists.size());
+	for (auto& cmdList : frame->WorkerCmdLists)
+		mCommandLists.emplace_back(mWorld, cmdList.Get());
+}
+
+unsigned World::D3DCommandRecorder::listCount() const
+{
+	return (unsigned)mCommandLists.size();
+}
+
+DrawCommandList& World::D3DCommandRecorder::beginList(unsigned index)
+{
+	FrameResource* frame = mWorld.mCurrFrameResource;
+	auto cmdListAlloc = frame->WorkerCmdListAllocs[index];
+	auto cmdList = frame->WorkerCmdLists[index];
+
+	// The GPU finished with this frame resource before Update handed it out.
+	ThrowIfFailed(cmdListAlloc->Reset());
+	ThrowIfFailed(cmdList->Reset(cmdListAlloc.Get(), nullptr));
+
+	// A command list starts with no state, so everything the draws share is set again.
+	cmdList->RSSetViewports(1, &mWorld.mScreenViewport);
+	cmdList->RSSetScissorRects(1, &mWorld.mScissorRect);
+
+	// Specify the buffers we are going to render to.
+	cmdList->OMSetRenderTargets(1, &mWorld.CurrentBackBufferView(), true, &mWorld.DepthStencilView());
+
+	ID3D12DescriptorHeap* descriptorHeaps[] = { mWorld.mSrvDescriptorHeap.Get() };
+	cmdList->SetDescriptorHeaps(_countof(descriptorHeaps), descriptorHeaps);
+
+	cmdList->SetGraphicsRootSignature(mWorld.mRootSignature.Get());
+
+	cmdList->SetGraphicsRootConstantBufferView(2, frame->PassCBAddress);
+
+	cmdList->SetGraphicsRootShaderResourceView(4, frame->ObjectData->Resource()->GetGPUVirtualAddress());
+	cmdList->SetGraphicsRootShaderResourceView(5, frame->InstanceIndicesAddress);
+
+	return mCommandLists[index];
+}
+
+void World::D3DCommandRecorder::endList(unsigned index)
+{
+	ThrowIfFailed(mWorld.mCurrFrameResource->WorkerCmdLists[index]->Close());
+}
+
+void World::D3DCommandList::setPipelineState(PsoHandle pso)
+{
+	mCmdList->SetPipelineState(mWorld.mPipelineStates[pso.Index]);
+}
+
+void World::D3DCommandList::setMaterial(MaterialHandle material)
+{
+	const Material& mat = mWorld.mScene.GetMaterial(material);
+
+	CD3DX12_GPU_DESCRIPTOR_HANDLE tex(mWorld.mSrvDescriptorHeap->GetGPUDescriptorHandleForHeapStart());
+	tex.Offset(mat.DiffuseSrvHeapIndex, mWorld.mCbvSrvDescriptorSize);
+
+	mCmdList->SetGraphicsRootDescriptorTable(0, tex);
+	mCmdList->SetGraphicsRootConstantBufferView(3, mMaterialCBAddress + mat.MatCBIndex * mMatCBByteSize);
+}
+
+void World::D3DCommandList::setMesh(MeshHandle mesh)
+{
+	MeshGeometry* geo = mWorld.mGeometries[mesh.Index].get();
+
+	mCmdList->IASetVertexBuffers(0, 1, &geo->VertexBufferView());
+	mCmdList->IASetIndexBuffer(&geo->IndexBufferView());
+}
+
+void World::D3DCommandList::setPrimitiveTopology(std::uint32_t topology)
+{
+	static_assert((std::uint32_t)PrimitiveTopology::TriangleList == D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST &&
+		(std::uint32_t)PrimitiveTopology::TriangleStrip == D3D_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP,
+		"PrimitiveTopology follows D3D_PRIMITIVE_TOPOLOGY");
+
+	mCmdList->IASetPrimitiveTopology((D3D12_PRIMITIVE_TOPOLOGY)topology);
+}
+
+void World::D3DCommandList::drawIndexedInstanced(std::uint32_t indexCount, std::uint32_t instanceCount,
+	std::uint32_t startIndexLocation, std::int32_t baseVertexLocation, std::uint32_t firstInstance)
+{
+	// SV_InstanceID does not include StartInstanceLocation, so the shader gets
+	// the offset as a root constant instead.
+	mCmdList->SetGraphicsRoot32BitConstant(1, firstInstance, 0);
+	mCmdList->DrawIndexedInstanced(indexCount, instanceCount, startIndexLocation, baseVertexLocation, 0);
+}
+
 std::array<const CD3DX12_STATIC_SAMPLER_DESC, 6> World::GetStaticSamplers()
 {
 	// Applications usually only need a handful of samplers.  So just define them all up front
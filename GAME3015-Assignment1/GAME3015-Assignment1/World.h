@@ -6,10 +6,9 @@
 #include "../../Common/GeometryGenerator.h"
 #include "../../Common/Camera.h"
 #include "FrameResource.h"
-#include "SceneNode.h"
-#include "World.h"
-#include <ctime>
-#include "Aircraft.h"
+#include "NullRenderDevice.h"
+#include "RenderDevice.h"
+#include "Scene.h"
 #include <vector>
 
 using Microsoft::WRL::ComPtr;
@@ -20,28 +19,41 @@ using namespace DirectX::PackedVector;
 #pragma comment(lib, "D3D12.lib")
 
 
-enum class RenderLayer : int
-{
-	Opaque = 0,
-	Transparent,
-	AlphaTested,
-	AlphaTestedTreeSprites,
-	Count
-};
-
+// The game window.  Owns the D3D12 backend the Scene renders through and
+// feeds the scene its input; the scene itself does not depend on D3DApp.
 class World : public D3DApp
 {
 public:
-	World(HINSTANCE hInstance);
+	// framesInFlight is how many frames the CPU may get ahead of the GPU; each
+	// gets its own frame resource.
+	World(HINSTANCE hInstance, int framesInFlight = gNumFrameResources);
 	World(const World& rhs) = delete;
 	World& operator=(const World& rhs) = delete;
 	~World();
 
 	virtual bool Initialize()override;
-	
+
+	// Builds the scene on a NullRenderDevice instead of a window and a D3D12
+	// device, so Update and Draw can run without a GPU.
+	bool InitializeHeadless();
+	RenderDevice& GetRenderDevice();
+
+	// Runs the scene simulation on a thread of its own, stepping every
+	// stepSeconds, instead of from Run.  The render thread draws the latest
+	// state it published.  Call before Initialize.
+	void EnableSimulationThread(float stepSeconds);
+
+	Scene& GetScene();
+
+	// Reads the keyboard from SetKeyDown instead of GetAsyncKeyState, so a
+	// replay sees the same input on every run.
+	void UseScriptedInput(bool scripted);
+	void SetKeyDown(int key, bool down);
+
 
 public:
 	virtual void OnResize()override;
+	virtual void Step(float dt)override;
 	virtual void Update(const GameTimer& gt)override;
 	virtual void Draw(const GameTimer& gt)override;
 
@@ -50,66 +62,130 @@ public:
 	virtual void OnMouseMove(WPARAM btnState, int x, int y)override;
 
 	void OnKeyboardInput(const GameTimer& gt);
-	void UpdateObjectCBs(const GameTimer& gt);
-	void UpdateMaterialCBs(const GameTimer& gt);
-	void UpdateMainPassCB(const GameTimer& gt);
+	bool IsKeyDown(int key) const;
 	void LoadTextures();
 	void BuildRootSignature();
 	void BuildDescriptorHeaps();
 	void BuildShadersAndInputLayouts();
-	void UpdateGameObjects(const GameTimer& gt);
-	void BuildGroundGeometry();
 	void BuildPSOs();
-	void BuildFrameResources();
-	void BuildMaterials();
-	void BuildRenderItems();
-	void DrawRenderItems(ID3D12GraphicsCommandList* cmdList, const std::vector<RenderItem*>& ritems);
 
 	std::array<const CD3DX12_STATIC_SAMPLER_DESC, 6> GetStaticSamplers();
 	
 private:
 
-	enum Layer
+	// Forwards what the draw queue emits to a D3D12 command list, reading the
+	// current frame resource's constant buffers.
+	class D3DCommandList : public DrawCommandList
+	{
+	public:
+		D3DCommandList(World& world, ID3D12GraphicsCommandList* cmdList);
+
+		virtual void setPipelineState(PsoHandle pso) override;
+		virtual void setMaterial(MaterialHandle material) override;
+		virtual void setMesh(MeshHandle mesh) override;
+		virtual void setPrimitiveTopology(std::uint32_t topology) override;
+		virtual void drawIndexedInstanced(std::uint32_t indexCount, std::uint32_t instanceCount,
+			std::uint32_t startIndexLocation, std::int32_t baseVertexLocation,
+			std::uint32_t firstInstance) override;
+
+	private:
+		World& mWorld;
+		ID3D12GraphicsCommandList* mCmdList;
+		D3D12_GPU_VIRTUAL_ADDRESS mMaterialCBAddress;
+		UINT mMatCBByteSize;
+	};
+
+	// Records draw chunks into the current frame resource's worker command lists.
+	class D3DCommandRecorder : public CommandRecorder
 	{
-		Background,
-		Air,
-		LayerCount
+	public:
+		explicit D3DCommandRecorder(World& world);
+
+		// Points the recorder at the current frame resource's worker lists.
+		void rebind();
+
+		virtual unsigned listCount() const override;
+		virtual DrawCommandList& beginList(unsigned index) override;
+		virtual void endList(unsigned index) override;
+
+	private:
+		World& mWorld;
+		std::vector<D3DCommandList> mCommandLists;
 	};
 
+	// D3DApp's fence, with one persistent wait event per frame resource.
+	class D3DFence : public FrameFence
+	{
+	public:
+		explicit D3DFence(World& world);
+		~D3DFence();
+
+		void createWaitObjects(int count);
+
+		virtual std::uint64_t completedValue() const override;
+		virtual void wait(int slot, std::uint64_t value) override;
+		virtual std::uint64_t signal() override;
+
+	private:
+		World& mWorld;
+		std::vector<HANDLE> mEvents;
+	};
+
+	// RenderDevice on top of the D3D12 objects D3DApp creates.
+	class D3DRenderDevice : public RenderDevice
+	{
+	public:
+		explicit D3DRenderDevice(World& world);
+
+		virtual void createMeshBuffers(MeshHandle mesh, const void* vertices, std::uint32_t vertexBytes,
+			std::uint32_t vertexStride, const void* indices, std::uint32_t indexBytes) override;
+		virtual void createFrameResources(int count, std::uint32_t objectCount, std::uint32_t materialCount) override;
+
+		virtual FrameFence& fence() override;
+		virtual void beginFrame(int frameResource) override;
+		virtual bool reserveObjects(std::uint32_t count) override;
+		virtual void upload(FrameBuffer buffer, std::uint32_t element, const void* data, std::size_t size) override;
+		virtual void uploadObjects(const ObjectTransforms& objects, ObjectTransforms::HandleRange handles, float alpha) override;
+		virtual void uploadFrameData(FrameBuffer buffer, const void* data, std::size_t size) override;
+		virtual void clear(const float color[4]) override;
+		virtual CommandRecorder& recorder() override;
+		virtual void endFrame(unsigned listCount) override;
+
+	private:
+		World& mWorld;
+		D3DCommandRecorder mRecorder;
+		D3DFence mFence;
+
+		// Runs after the worker lists; transitions the back buffer for present.
+		ComPtr<ID3D12GraphicsCommandList> mPostCommandList;
+		std::vector<ID3D12CommandList*> mSubmitLists;
+	};
+
+	// Every upload and submission of the frame path goes through this.
+	std::unique_ptr<RenderDevice> mRenderDevice;
+
 	std::vector<std::unique_ptr<FrameResource>> mFrameResources;
 	FrameResource* mCurrFrameResource = nullptr;
-	int mCurrFrameResourceIndex = 0;
 	UINT mCbvSrvDescriptorSize = 0;
 	ComPtr<ID3D12RootSignature> mRootSignature = nullptr;
 	ComPtr<ID3D12DescriptorHeap> mSrvDescriptorHeap = nullptr;
-	std::unordered_map<std::string, std::unique_ptr<MeshGeometry>> mGeometries;
-	std::unordered_map<std::string, std::unique_ptr<Material>> mMaterials;
 	std::unordered_map<std::string, std::unique_ptr<Texture>> mTextures;
 	std::unordered_map<std::string, ComPtr<ID3DBlob>> mShaders;
 	std::unordered_map<std::string, ComPtr<ID3D12PipelineState>> mPSOs;
 	std::vector<D3D12_INPUT_ELEMENT_DESC> mStdInputLayout;
 
-	// List of all the render items.
-	std::vector<std::unique_ptr<RenderItem>> mAllRitems;
+	// The D3D12 objects behind the scene's pipeline and mesh handles,
+	// indexed by handle.
+	std::vector<ID3D12PipelineState*>				mPipelineStates;
+	std::vector<std::unique_ptr<MeshGeometry>>		mGeometries;
 
-	// Render items divided by PSO.
-	std::vector<RenderItem*> mRitemLayer[(int)RenderLayer::Count];
-
-	PassConstants mMainPassCB;
-	Camera mCamera;
 	POINT mLastMousePos;
 
-	SceneNode							mSceneGraph;
-	std::array<SceneNode*, LayerCount>	mSceneLayers;
-
-	XMFLOAT4	mWorldBounds;
-	XMVECTOR	mSpawnPosition;
-	float		mScrollSpeed;
-
-	Aircraft* mPlane;
-	Aircraft* leftPlane;
-	Aircraft* rightPlane;
-	Entity background;
-	Entity background2;
+	// Key states set by SetKeyDown, used instead of the keyboard when scripted.
+	bool mScriptedInput = false;
+	std::array<bool, 256> mScriptedKeys = {};
 
+	// Declared last: it is destroyed first, stopping the simulation thread
+	// before anything it could touch goes away.
+	Scene mScene;
 };
\ No newline at end of file
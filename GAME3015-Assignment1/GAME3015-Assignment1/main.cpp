@@ -1,10 +1,58 @@
 
 #include "Game.h"
+#include "Replay.h"
+#include <cstdio>
+#include <fstream>
+#include <iostream>
 
 
 //#pragma comment(lib, "d3dcompiler.lib")
 //#pragma comment(lib, "D3D12.lib")
 
+namespace
+{
+	// Runs the scene without a window for a fixed number of frames and
+	// reports per-frame timings and scene hashes.
+	int runReplay(HINSTANCE hInstance, const Replay::Options& options)
+	{
+		InputScript input;
+		if (!options.InputPath.empty())
+		{
+			std::ifstream file(options.InputPath);
+			if (!file || !input.load(file))
+			{
+				std::wstring message = L"Cannot read input script " + AnsiToWString(options.InputPath);
+				if (input.errorLine() > 0)
+					message += L", line " + std::to_wstring(input.errorLine());
+				MessageBox(nullptr, message.c_str(), L"Replay", MB_OK);
+				return 1;
+			}
+		}
+
+		World world(hInstance);
+		if (!world.InitializeHeadless())
+			return 1;
+
+		Replay replay(world, input);
+		if (!options.OutputPath.empty())
+		{
+			std::ofstream out(options.OutputPath);
+			replay.run(options, out);
+			return out ? 0 : 1;
+		}
+
+		// A windows application has no console of its own; write to the one
+		// it was started from.
+		FILE* console = nullptr;
+		if (AttachConsole(ATTACH_PARENT_PROCESS))
+			freopen_s(&console, "CONOUT$", "w", stdout);
+
+		replay.run(options, std::cout);
+		std::cout.flush();
+		return 0;
+	}
+}
+
 int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE prevInstance,
 	PSTR cmdLine, int showCmd)
 {
@@ -15,6 +63,10 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE prevInstance,
 
 	try
 	{
+		Replay::Options replayOptions;
+		if (Replay::parseCommandLine(cmdLine, replayOptions))
+			return runReplay(hInstance, replayOptions);
+
 		Game theApp(hInstance);
 		if (!theApp.Initialize())
 			return 0;
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <iostream>
+
+// Just enough of a test framework for the test executables: CHECK and
+// CHECK_EQUAL report a failure and carry on, and checkResult() makes the
+// process exit code say whether any of them failed.
+inline int& checkFailureCount()
+{
+	static int failures = 0;
+	return failures;
+}
+
+#define CHECK(expr) \
+	do { \
+		if (!(expr)) { \
+			std::cerr << __FILE__ << ':' << __LINE__ << ": CHECK(" #expr ") failed\n"; \
+			++checkFailureCount(); \
+		} \
+	} while (0)
+
+#define CHECK_EQUAL(expected, actual) \
+	do { \
+		const auto& checkExpected = (expected); \
+		const auto& checkActual = (actual); \
+		if (!(checkExpected == checkActual)) { \
+			std::cerr << __FILE__ << ':' << __LINE__ << ": CHECK_EQUAL(" #expected ", " #actual ") failed: " \
+				<< checkExpected << " != " << checkActual << '\n'; \
+			++checkFailureCount(); \
+		} \
+	} while (0)
+
+inline int checkResult()
+{
+	if (checkFailureCount() == 0)
+		return 0;
+
+	std::cerr << checkFailureCount() << " check(s) failed\n";
+	return 1;
+}
@@ -0,0 +1,270 @@
+#include "Check.h"
+#include "DrawQueue.h"
+#include "NullCommandRecorder.h"
+#include "RecordingCommandList.h"
+#include "ThreadPool.h"
+#include <vector>
+
+namespace
+{
+	typedef RecordingCommandList::Command Command;
+
+	template<typename Handle>
+	Handle handle(std::uint32_t index)
+	{
+		Handle h;
+		h.Index = index;
+		return h;
+	}
+
+	// Every packet draws from its own index range unless told otherwise, so
+	// only packets meant to merge do.
+	DrawQueue::Packet packet(std::uint32_t object, std::uint32_t pso, std::uint32_t material, std::uint32_t mesh,
+		float depth = 0.0f, std::uint32_t pass = 0, bool backToFront = false)
+	{
+		DrawQueue::Packet p;
+		p.Pass = pass;
+		p.BackToFront = backToFront;
+		p.Pso = handle<PsoHandle>(pso);
+		p.Material = handle<MaterialHandle>(material);
+		p.Mesh = handle<MeshHandle>(mesh);
+		p.Topology = 4;
+		p.Depth = depth;
+		p.ObjCBIndex = object;
+		p.IndexCount = 36;
+		p.StartIndexLocation = object * 36;
+		return p;
+	}
+
+	std::vector<std::uint32_t> drawOrder(DrawQueue& queue)
+	{
+		queue.sort();
+		return queue.getInstanceObjects();
+	}
+
+	void testSkipsRedundantBinds()
+	{
+		DrawQueue queue;
+		queue.add(packet(0, 0, 0, 0));
+		queue.add(packet(1, 0, 0, 0));
+		queue.add(packet(2, 0, 1, 0));
+		queue.add(packet(3, 1, 1, 1));
+		queue.sort();
+
+		RecordingCommandList list;
+		DrawQueue::Stats stats = queue.submit(list);
+
+		const Command::Type expected[] = {
+			Command::SetPipelineState, Command::SetMesh, Command::SetPrimitiveTopology, Command::SetMaterial,
+			Command::DrawIndexedInstanced,
+			Command::DrawIndexedInstanced,
+			Command::SetMaterial, Command::DrawIndexedInstanced,
+			Command::SetPipelineState, Command::SetMesh, Command::DrawIndexedInstanced,
+		};
+		const std::size_t expectedCount = sizeof(expected) / sizeof(expected[0]);
+		const std::vector<Command>& commands = list.getCommands();
+		CHECK_EQUAL(expectedCount, commands.size());
+		for (std::size_t i = 0; i < commands.size() && i < expectedCount; ++i)
+			CHECK_EQUAL((int)expected[i], (int)commands[i].Kind);
+
+		CHECK_EQUAL(4u, stats.Draws);
+		CHECK_EQUAL(2u, stats.PsoBinds);
+		CHECK_EQUAL(2u, stats.PsoBindsSkipped);
+		CHECK_EQUAL(2u, stats.MaterialBinds);
+		CHECK_EQUAL(2u, stats.MaterialBindsSkipped);
+		CHECK_EQUAL(2u, stats.MeshBinds);
+		CHECK_EQUAL(2u, stats.MeshBindsSkipped);
+		CHECK_EQUAL(1u, stats.TopologyBinds);
+		CHECK_EQUAL(3u, stats.TopologyBindsSkipped);
+		CHECK_EQUAL(9u, stats.skipped());
+	}
+
+	// Opaque passes sort by state, then near to far.
+	void testFrontToBackOrder()
+	{
+		DrawQueue queue;
+		queue.add(packet(0, 1, 0, 0, 0.1f));
+		queue.add(packet(1, 0, 1, 0, 0.1f));
+		queue.add(packet(2, 0, 0, 1, 0.1f));
+		queue.add(packet(3, 0, 0, 0, 0.9f));
+		queue.add(packet(4, 0, 0, 0, 0.2f));
+
+		const std::vector<std::uint32_t> expected = { 4, 3, 2, 1, 0 };
+		CHECK(drawOrder(queue) == expected);
+	}
+
+	// Blended passes sort far to near first and by state only at equal
+	// depth.  Depths outside [0, 1] are clamped.
+	void testBackToFrontOrder()
+	{
+		DrawQueue queue;
+		queue.add(packet(0, 0, 0, 0, 0.2f, 0, true));
+		queue.add(packet(1, 1, 0, 0, 0.8f, 0, true));
+		queue.add(packet(2, 0, 0, 0, 5.0f, 0, true));
+		queue.add(packet(3, 1, 0, 0, 0.5f, 0, true));
+		queue.add(packet(4, 0, 0, 0, 0.5f, 0, true));
+		queue.add(packet(5, 0, 0, 0, -1.0f, 0, true));
+
+		const std::vector<std::uint32_t> expected = { 2, 1, 4, 3, 0, 5 };
+		CHECK(drawOrder(queue) == expected);
+	}
+
+	// The pass wins over everything else; equal keys keep the order they were
+	// added in.
+	void testPassOrderAndStability()
+	{
+		DrawQueue queue;
+		queue.add(packet(0, 0, 0, 0, 0.9f, 2, true));
+		queue.add(packet(1, 2, 2, 2, 0.5f, 0));
+		queue.add(packet(2, 0, 0, 0, 0.5f, 1));
+		queue.add(packet(3, 2, 2, 2, 0.5f, 0));
+		queue.add(packet(4, 0, 0, 0, 0.0f, 0));
+
+		const std::vector<std::uint32_t> expected = { 4, 1, 3, 2, 0 };
+		CHECK(drawOrder(queue) == expected);
+	}
+
+	void testMergesInstancedRuns()
+	{
+		DrawQueue queue;
+		for (std::uint32_t object = 0; object < 3; ++object)
+		{
+			DrawQueue::Packet p = packet(object, 0, 0, 0, 0.1f * object);
+			p.StartIndexLocation = 0;
+			queue.add(p);
+		}
+
+		// Same state, different index range: a draw of its own.
+		queue.add(packet(3, 0, 0, 0, 0.5f));
+
+		// The same draw in the next pass is never merged across passes.
+		DrawQueue::Packet nextPass = packet(4, 0, 0, 0, 0.0f, 1);
+		nextPass.StartIndexLocation = 0;
+		queue.add(nextPass);
+		queue.sort();
+
+		RecordingCommandList list;
+		DrawQueue::Stats stats = queue.submit(list);
+		CHECK_EQUAL(3u, stats.Draws);
+		CHECK_EQUAL(5u, stats.Instances);
+
+		std::vector<Command> draws;
+		for (const Command& command : list.getCommands())
+			if (command.Kind == Command::DrawIndexedInstanced)
+				draws.push_back(command);
+
+		CHECK_EQUAL(3u, draws.size());
+		if (draws.size() == 3)
+		{
+			CHECK_EQUAL(3u, draws[0].InstanceCount);
+			CHECK_EQUAL(0u, draws[0].FirstInstance);
+			CHECK_EQUAL(1u, draws[1].InstanceCount);
+			CHECK_EQUAL(3u, draws[1].FirstInstance);
+			CHECK_EQUAL(3u * 36, draws[1].StartIndexLocation);
+			CHECK_EQUAL(1u, draws[2].InstanceCount);
+			CHECK_EQUAL(4u, draws[2].FirstInstance);
+		}
+
+		// firstInstance indexes the sorted object list.
+		const std::vector<std::uint32_t> expected = { 0, 1, 2, 3, 4 };
+		CHECK(queue.getInstanceObjects() == expected);
+	}
+
+	// Splits the queue and checks the chunks cover every packet in order.
+	// Returns the size of each chunk.
+	std::vector<std::uint32_t> split(const DrawQueue& queue, std::size_t maxPackets, std::size_t maxChunks)
+	{
+		std::vector<DrawQueue::Chunk> chunks;
+		queue.split(maxPackets, maxChunks, chunks);
+
+		std::vector<std::uint32_t> counts;
+		std::uint32_t next = 0;
+		for (const DrawQueue::Chunk& chunk : chunks)
+		{
+			CHECK_EQUAL(next, chunk.First);
+			next += chunk.Count;
+			counts.push_back(chunk.Count);
+		}
+		CHECK_EQUAL(queue.size(), (std::size_t)next);
+
+		return counts;
+	}
+
+	void testSplitBalancesChunks()
+	{
+		// Ten separate draws in pass 0, three in pass 1.
+		DrawQueue queue;
+		for (std::uint32_t object = 0; object < 13; ++object)
+			queue.add(packet(object, 0, 0, 0, 0.0f, object < 10 ? 0 : 1));
+		queue.sort();
+
+		// Passes are cut at maxPackets and never share a chunk.
+		CHECK(split(queue, 4, 16) == std::vector<std::uint32_t>({ 4, 4, 2, 3 }));
+		CHECK(split(queue, 100, 16) == std::vector<std::uint32_t>({ 10, 3 }));
+
+		// Too many chunks: the smallest neighbouring pair is merged first.
+		CHECK(split(queue, 4, 3) == std::vector<std::uint32_t>({ 4, 4, 5 }));
+		CHECK(split(queue, 4, 2) == std::vector<std::uint32_t>({ 8, 5 }));
+		CHECK(split(queue, 4, 1) == std::vector<std::uint32_t>({ 13 }));
+	}
+
+	void testSplitKeepsInstancedRunsWhole()
+	{
+		DrawQueue queue;
+		for (std::uint32_t object = 0; object < 6; ++object)
+		{
+			DrawQueue::Packet p = packet(object, 0, 0, 0);
+			p.StartIndexLocation = 0;
+			queue.add(p);
+		}
+		queue.add(packet(6, 0, 0, 0));
+		queue.add(packet(7, 0, 0, 0));
+		queue.sort();
+
+		CHECK(split(queue, 4, 16) == std::vector<std::uint32_t>({ 6, 2 }));
+	}
+
+	// Recording chunks on several threads emits the same draws as one list,
+	// and every chunk binds its state from scratch.
+	void testRecordMatchesSubmit()
+	{
+		DrawQueue queue;
+		for (std::uint32_t object = 0; object < 40; ++object)
+			queue.add(packet(object, object % 3, object % 5, object % 2, 0.01f * object, object % 2));
+		queue.sort();
+
+		RecordingCommandList single;
+		DrawQueue::Stats whole = queue.submit(single);
+
+		ThreadPool pool(4);
+		NullCommandRecorder recorder(4);
+		DrawQueue::Stats recorded = queue.record(recorder, pool, 8);
+
+		CHECK_EQUAL(4u, recorded.Lists);
+		CHECK_EQUAL(whole.Draws, recorded.Draws);
+		CHECK_EQUAL(whole.Instances, recorded.Instances);
+
+		std::uint32_t draws = 0;
+		for (unsigned i = 0; i < recorder.usedCount(); ++i)
+		{
+			const std::vector<Command>& commands = recorder.getList(i).getCommands();
+			CHECK(!commands.empty() && commands.front().Kind == Command::SetPipelineState);
+			draws += recorder.getList(i).count(Command::DrawIndexedInstanced);
+		}
+		CHECK_EQUAL(whole.Draws, draws);
+	}
+}
+
+int main()
+{
+	testSkipsRedundantBinds();
+	testFrontToBackOrder();
+	testBackToFrontOrder();
+	testPassOrderAndStability();
+	testMergesInstancedRuns();
+	testSplitBalancesChunks();
+	testSplitKeepsInstancedRunsWhole();
+	testRecordMatchesSubmit();
+
+	return checkResult();
+}
@@ -0,0 +1,72 @@
+#include "Check.h"
+#include "FrameScheduler.h"
+#include "SimulatedFence.h"
+#include <cstdint>
+
+namespace
+{
+	// Runs frames the way the Scene does and returns how many of them had to
+	// wait for the GPU to release their frame resource.
+	std::uint64_t countStalls(int framesInFlight, unsigned latency, int frames)
+	{
+		SimulatedFence fence(latency);
+		FrameScheduler scheduler;
+		scheduler.reset(fence, framesInFlight);
+
+		for (int i = 0; i < frames; ++i)
+		{
+			scheduler.beginFrame();
+			scheduler.waitReady();
+			CHECK(scheduler.isReady());
+			scheduler.endFrame();
+		}
+
+		CHECK_EQUAL((std::uint64_t)frames, scheduler.getStats().Frames);
+		CHECK_EQUAL(scheduler.getStats().Stalls, fence.getWaitCount());
+		return scheduler.getStats().Stalls;
+	}
+
+	void testThreeFramesInFlight()
+	{
+		// A GPU up to two frames behind never holds up the CPU.
+		CHECK_EQUAL(0u, countStalls(3, 1, 100));
+		CHECK_EQUAL(0u, countStalls(3, 2, 100));
+
+		// Three behind, every frame after the first three waits.
+		CHECK_EQUAL(97u, countStalls(3, 3, 100));
+	}
+
+	void testOneFrameInFlight()
+	{
+		CHECK_EQUAL(0u, countStalls(1, 0, 100));
+
+		// Every frame after the first waits for the one before it.
+		CHECK_EQUAL(99u, countStalls(1, 1, 100));
+	}
+
+	// Frame resources are handed out in turn and wrap around.
+	void testFrameOrder()
+	{
+		SimulatedFence fence(1);
+		FrameScheduler scheduler;
+		scheduler.reset(fence, 3);
+
+		const int expected[] = { 1, 2, 0, 1, 2, 0 };
+		for (int frame : expected)
+		{
+			CHECK_EQUAL(frame, scheduler.beginFrame());
+			CHECK_EQUAL(frame, scheduler.currentFrame());
+			scheduler.waitReady();
+			scheduler.endFrame();
+		}
+	}
+}
+
+int main()
+{
+	testThreeFramesInFlight();
+	testOneFrameInFlight();
+	testFrameOrder();
+
+	return checkResult();
+}
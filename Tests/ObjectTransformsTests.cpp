@@ -0,0 +1,99 @@
+#include "Check.h"
+#include "ObjectTransforms.h"
+#include <algorithm>
+#include <vector>
+
+namespace
+{
+	const std::size_t Stride = 2 * sizeof(XMFLOAT4X4);
+	const std::size_t MaxObjects = 4;
+
+	// The z translation of the world matrix streamConstants writes for handle.
+	// The matrix is written transposed, so it is the last column's third row.
+	float streamedZ(const ObjectTransforms& objects, ObjectTransforms::Handle handle, float alpha)
+	{
+		alignas(16) float constants[MaxObjects * Stride / sizeof(float)];
+		const ObjectTransforms::Handle handles[] = { handle };
+		ObjectTransforms::HandleRange one = { handles, handles + 1 };
+
+		objects.streamConstants(one, constants, Stride, alpha);
+		return constants[handle * Stride / sizeof(float) + 11];
+	}
+
+	std::vector<ObjectTransforms::Handle> moving(const ObjectTransforms& objects)
+	{
+		std::vector<ObjectTransforms::Handle> handles(objects.getMoving().begin(), objects.getMoving().end());
+		std::sort(handles.begin(), handles.end());
+		return handles;
+	}
+
+	// Frames between steps blend from the previous step to the latest one.
+	void testMovingObjectIsBlended()
+	{
+		ObjectTransforms objects(1);
+		ObjectTransforms::Handle handle = objects.add(XMMatrixTranslation(0.0f, 0.0f, 0.0f), XMMatrixIdentity());
+
+		objects.beginStep();
+		objects.setWorld(handle, XMMatrixTranslation(0.0f, 0.0f, 1.0f));
+
+		CHECK_EQUAL(0.5f, streamedZ(objects, handle, 0.5f));
+		CHECK_EQUAL(1.0f, streamedZ(objects, handle, 1.0f));
+	}
+
+	// An object wrapped from one end of the scene to the other is drawn at
+	// its new position, not swept across the scene.
+	void testSnappedObjectIsNotBlended()
+	{
+		ObjectTransforms objects(1);
+		ObjectTransforms::Handle handle = objects.add(XMMatrixTranslation(0.0f, 0.0f, -12.0f), XMMatrixIdentity());
+		objects.clearDirty(0);
+
+		objects.beginStep();
+		objects.setWorld(handle, XMMatrixTranslation(0.0f, 0.0f, 12.0f));
+		objects.resetInterpolation(handle);
+
+		CHECK_EQUAL(12.0f, streamedZ(objects, handle, 0.0f));
+		CHECK_EQUAL(12.0f, streamedZ(objects, handle, 0.5f));
+		CHECK(moving(objects).empty());
+
+		// It still has to be uploaded.
+		CHECK(objects.isDirty(handle, 0));
+
+		// Moving on from there blends from where it jumped to.
+		objects.beginStep();
+		objects.setWorld(handle, XMMatrixTranslation(0.0f, 0.0f, 11.0f));
+		CHECK_EQUAL(11.5f, streamedZ(objects, handle, 0.5f));
+	}
+
+	// Snapping one object leaves the others moving.
+	void testSnapKeepsOtherObjectsMoving()
+	{
+		ObjectTransforms objects(1);
+		std::vector<ObjectTransforms::Handle> handles;
+		for (std::size_t i = 0; i < MaxObjects; ++i)
+			handles.push_back(objects.add(XMMatrixIdentity(), XMMatrixIdentity()));
+
+		objects.beginStep();
+		for (ObjectTransforms::Handle handle : handles)
+			objects.setWorld(handle, XMMatrixTranslation(0.0f, 0.0f, 2.0f));
+		objects.resetInterpolation(handles[1]);
+
+		const std::vector<ObjectTransforms::Handle> expected = { handles[0], handles[2], handles[3] };
+		CHECK(moving(objects) == expected);
+		CHECK_EQUAL(1.0f, streamedZ(objects, handles[3], 0.5f));
+		CHECK_EQUAL(2.0f, streamedZ(objects, handles[1], 0.5f));
+
+		// Moved again in the same step, it is listed once.
+		objects.setWorld(handles[1], XMMatrixTranslation(0.0f, 0.0f, 3.0f));
+		CHECK_EQUAL(4u, moving(objects).size());
+	}
+}
+
+int main()
+{
+	testMovingObjectIsBlended();
+	testSnappedObjectIsNotBlended();
+	testSnapKeepsOtherObjectsMoving();
+
+	return checkResult();
+}
@@ -0,0 +1,193 @@
+#include "../Common/FixedTimestep.h"
+#include "Check.h"
+#include "NullRenderDevice.h"
+#include "Scene.h"
+#include <cstdlib>
+#include <vector>
+
+// Runs the scene on a NullRenderDevice and checks what it asks the device to
+// draw and upload.  The scene is two background tiles sharing a mesh and
+// material, a Raptor and two Eagles, all on the shared box mesh.
+
+namespace
+{
+	const std::size_t ObjectCount = 5;
+	const std::size_t MaterialCount = 3;
+
+	// The box, subdivided once: 72 vertices and 144 16-bit indices.
+	const std::uint32_t BoxIndexCount = 144;
+	const std::uint64_t BoxMeshBytes = 72 * sizeof(Vertex) + BoxIndexCount * sizeof(std::uint16_t);
+
+	void runFrames(Scene& scene, int frames, bool step)
+	{
+		for (int i = 0; i < frames; ++i)
+		{
+			if (step)
+				scene.Step(1.0f / 60.0f);
+			scene.Update(i / 60.0f, 1.0f / 60.0f, 1.0f);
+			scene.Draw();
+		}
+	}
+
+	void testFirstFrame()
+	{
+		Scene scene;
+		NullRenderDevice device(scene.GetThreadPool().threadCount());
+		scene.Build(device);
+
+		CHECK_EQUAL(ObjectCount, scene.GetRenderItemCount());
+		CHECK_EQUAL(BoxMeshBytes, device.getStats().MeshBytes);
+
+		runFrames(scene, 1, true);
+
+		const NullRenderDevice::Stats& stats = device.getStats();
+		CHECK_EQUAL(1u, stats.Frames);
+		CHECK_EQUAL(1u, stats.Clears);
+
+		// The tiles and the Eagles are drawn instanced, the Raptor on its own.
+		CHECK_EQUAL(3u, stats.Draws);
+
+		std::vector<std::uint32_t> instances;
+		for (unsigned i = 0; i < device.getRecorder().usedCount(); ++i)
+			for (const RecordingCommandList::Command& command : device.getRecorder().getList(i).getCommands())
+				if (command.Kind == RecordingCommandList::Command::DrawIndexedInstanced)
+				{
+					CHECK_EQUAL(BoxIndexCount, command.Value);
+					instances.push_back(command.InstanceCount);
+				}
+
+		std::uint32_t totalInstances = 0;
+		for (std::uint32_t count : instances)
+			totalInstances += count;
+		CHECK_EQUAL(3u, (unsigned)instances.size());
+		CHECK_EQUAL(ObjectCount, totalInstances);
+
+		// Every object and material goes to the fresh frame resource.
+		CHECK_EQUAL(ObjectCount, stats.Uploads[(int)FrameBuffer::ObjectData]);
+		CHECK_EQUAL(ObjectCount * NullRenderDevice::ObjectStride, stats.UploadBytes[(int)FrameBuffer::ObjectData]);
+		CHECK_EQUAL(MaterialCount, stats.Uploads[(int)FrameBuffer::MaterialConstants]);
+		CHECK_EQUAL(MaterialCount * sizeof(MaterialConstants), stats.UploadBytes[(int)FrameBuffer::MaterialConstants]);
+
+		CHECK_EQUAL(1u, stats.Uploads[(int)FrameBuffer::PassConstants]);
+		CHECK_EQUAL(sizeof(PassConstants), stats.UploadBytes[(int)FrameBuffer::PassConstants]);
+		CHECK_EQUAL(1u, stats.Uploads[(int)FrameBuffer::InstanceIndices]);
+		CHECK_EQUAL(ObjectCount * sizeof(std::uint32_t), stats.UploadBytes[(int)FrameBuffer::InstanceIndices]);
+		CHECK_EQUAL(0u, stats.ObjectBufferGrowths);
+	}
+
+	// Without simulation steps nothing changes, so each frame resource gets
+	// the objects and materials once and then only the per-frame data.
+	void testStaticSceneUploadsOncePerFrameResource()
+	{
+		const int framesInFlight = 3;
+		const int frames = 10;
+
+		Scene scene(framesInFlight);
+		NullRenderDevice device(scene.GetThreadPool().threadCount());
+		scene.Build(device);
+
+		runFrames(scene, frames, false);
+
+		const NullRenderDevice::Stats& stats = device.getStats();
+		CHECK_EQUAL((std::uint64_t)frames, stats.Frames);
+		CHECK_EQUAL(3u * frames, stats.Draws);
+
+		CHECK_EQUAL(ObjectCount * framesInFlight, stats.Uploads[(int)FrameBuffer::ObjectData]);
+		CHECK_EQUAL(ObjectCount * framesInFlight * NullRenderDevice::ObjectStride,
+			stats.UploadBytes[(int)FrameBuffer::ObjectData]);
+		CHECK_EQUAL(MaterialCount * framesInFlight, stats.Uploads[(int)FrameBuffer::MaterialConstants]);
+
+		CHECK_EQUAL((std::uint64_t)frames, stats.Uploads[(int)FrameBuffer::PassConstants]);
+		CHECK_EQUAL(frames * sizeof(PassConstants), stats.UploadBytes[(int)FrameBuffer::PassConstants]);
+		CHECK_EQUAL(frames * ObjectCount * sizeof(std::uint32_t), stats.UploadBytes[(int)FrameBuffer::InstanceIndices]);
+	}
+
+	// A dirty material is uploaded again to every frame resource, and only that.
+	void testDirtyMaterialReachesEveryFrameResource()
+	{
+		const int framesInFlight = 3;
+
+		Scene scene(framesInFlight);
+		NullRenderDevice device(scene.GetThreadPool().threadCount());
+		scene.Build(device);
+
+		runFrames(scene, framesInFlight, false);
+		const std::uint64_t before = device.getStats().Uploads[(int)FrameBuffer::MaterialConstants];
+
+		scene.MarkMaterialDirty(MaterialHandle{ 0 });
+		runFrames(scene, 2 * framesInFlight, false);
+
+		CHECK_EQUAL(before + framesInFlight, device.getStats().Uploads[(int)FrameBuffer::MaterialConstants]);
+		CHECK_EQUAL(ObjectCount * framesInFlight, device.getStats().Uploads[(int)FrameBuffer::ObjectData]);
+	}
+
+	// Moving objects are uploaded every frame; the draws stay the same.
+	void testSteppedSceneKeepsDrawing()
+	{
+		Scene scene;
+		NullRenderDevice device(scene.GetThreadPool().threadCount());
+		scene.Build(device);
+
+		const std::uint64_t hash = scene.HashRenderItems();
+		runFrames(scene, 30, true);
+
+		const NullRenderDevice::Stats& stats = device.getStats();
+		CHECK_EQUAL(30u, stats.Frames);
+		CHECK_EQUAL(3u * 30, stats.Draws);
+		CHECK(stats.Uploads[(int)FrameBuffer::ObjectData] > ObjectCount * gNumFrameResources);
+		CHECK(scene.HashRenderItems() != hash);
+	}
+
+	// The frame hashes of a headless replay, stepped the way Headless steps
+	// it, with frames of frameTime seconds.
+	std::vector<std::uint64_t> replayHashes(int frames, double frameTime)
+	{
+		Scene scene;
+		NullRenderDevice device(scene.GetThreadPool().threadCount());
+		scene.Build(device);
+
+		FixedTimestep stepClock(1.0f / 60.0f);
+		double totalTime = 0.0;
+
+		std::vector<std::uint64_t> hashes;
+		for (int frame = 0; frame < frames; ++frame)
+		{
+			totalTime += frameTime;
+			int steps = stepClock.advance(frameTime);
+			for (int i = 0; i < steps; ++i)
+				scene.Step(stepClock.step());
+
+			scene.Update((float)totalTime, (float)frameTime, stepClock.alpha());
+			scene.Draw();
+			hashes.push_back(scene.HashRenderItems());
+		}
+		return hashes;
+	}
+
+	// The same replay gives the same hash every frame, whatever rand was
+	// seeded with before it.  Long enough for the background to wrap.
+	void testReplayIsRepeatable()
+	{
+		const int frames = 2000;
+		const double frameTime = 1.0 / 45.0;
+
+		std::srand(1);
+		const std::vector<std::uint64_t> first = replayHashes(frames, frameTime);
+		std::srand(2);
+		const std::vector<std::uint64_t> second = replayHashes(frames, frameTime);
+
+		CHECK(first == second);
+		CHECK(first.front() != first.back());
+	}
+}
+
+int main()
+{
+	testFirstFrame();
+	testStaticSceneUploadsOncePerFrameResource();
+	testDirtyMaterialReachesEveryFrameResource();
+	testSteppedSceneKeepsDrawing();
+	testReplayIsRepeatable();
+
+	return checkResult();
+}
@@ -0,0 +1,72 @@
+#include "Check.h"
+#include "ThreadPool.h"
+#include <atomic>
+#include <stdexcept>
+
+namespace
+{
+	void testRunsEveryJob(unsigned threads)
+	{
+		ThreadPool pool(threads);
+		std::atomic<int> ran(0);
+
+		for (int i = 0; i < 100; ++i)
+			pool.submit([&]()
+			{
+				++ran;
+
+				// Jobs submitted by jobs are waited for too.
+				pool.submit([&]() { ++ran; });
+			});
+		pool.wait();
+
+		CHECK_EQUAL(200, ran.load());
+	}
+
+	// A throwing job still counts as finished; wait() lets the others finish,
+	// rethrows the first exception and leaves the pool usable.
+	void testRethrowsFromWait(unsigned threads)
+	{
+		ThreadPool pool(threads);
+		std::atomic<int> ran(0);
+
+		for (int i = 0; i < 100; ++i)
+			pool.submit([&, i]()
+			{
+				++ran;
+				if (i % 10 == 0)
+					throw std::runtime_error("job failed");
+			});
+
+		bool caught = false;
+		try
+		{
+			pool.wait();
+		}
+		catch (const std::runtime_error&)
+		{
+			caught = true;
+		}
+
+		CHECK(caught);
+		CHECK_EQUAL(100, ran.load());
+
+		// The error was handed out once; the next batch runs clean.
+		ran = 0;
+		for (int i = 0; i < 10; ++i)
+			pool.submit([&]() { ++ran; });
+		pool.wait();
+		CHECK_EQUAL(10, ran.load());
+	}
+}
+
+int main()
+{
+	for (unsigned threads : { 1u, 2u, 4u })
+	{
+		testRunsEveryJob(threads);
+		testRethrowsFromWait(threads);
+	}
+
+	return checkResult();
+}
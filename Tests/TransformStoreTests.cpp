@@ -0,0 +1,113 @@
+#include "Check.h"
+#include "ThreadPool.h"
+#include "TransformStore.h"
+#include <cstdlib>
+#include <vector>
+
+namespace
+{
+	// A few thousand roots, each with a chain of children under it, built
+	// children-first so the store has to reorder itself.
+	void buildForest(TransformStore& store, std::vector<TransformStore::Handle>& handles, unsigned seed)
+	{
+		std::srand(seed);
+
+		const int roots = 3000;
+		const int depth = 4;
+		for (int r = 0; r < roots; ++r)
+		{
+			TransformStore::Handle chain[depth];
+			for (int d = depth - 1; d >= 0; --d)
+				chain[d] = store.create();
+			for (int d = 1; d < depth; ++d)
+				store.setParent(chain[d], chain[d - 1]);
+
+			for (int d = 0; d < depth; ++d)
+			{
+				float x = (float)(std::rand() % 100) * 0.1f;
+				store.setPosition(chain[d], XMVectorSet(x, 0.5f * d, -x, 1.0f));
+				store.setScale(chain[d], XMVectorSet(1.0f, 1.0f + 0.1f * d, 1.0f, 0.0f));
+				if (std::rand() % 3 == 0)
+					store.setVelocity(chain[d], XMVectorSet(1.0f, 0.0f, 0.5f, 0.0f));
+				handles.push_back(chain[d]);
+			}
+		}
+	}
+
+	bool sameWorld(const TransformStore& a, const TransformStore& b, TransformStore::Handle handle)
+	{
+		XMFLOAT4X4 wa, wb;
+		XMStoreFloat4x4(&wa, a.getWorldTransform(handle));
+		XMStoreFloat4x4(&wb, b.getWorldTransform(handle));
+		for (int r = 0; r < 4; ++r)
+			for (int c = 0; c < 4; ++c)
+				if (wa.m[r][c] != wb.m[r][c])
+					return false;
+		return a.worldChanged(handle) == b.worldChanged(handle);
+	}
+
+	// The sweeps split over the pool give bit for bit what the serial ones do.
+	void testParallelSweepsMatchSerial()
+	{
+		TransformStore serial;
+		TransformStore parallel;
+		std::vector<TransformStore::Handle> handles;
+		std::vector<TransformStore::Handle> parallelHandles;
+		buildForest(serial, handles, 7);
+		buildForest(parallel, parallelHandles, 7);
+		CHECK(handles == parallelHandles);
+
+		ThreadPool pool(4);
+		for (int step = 0; step < 5; ++step)
+		{
+			// Hierarchy changes between steps as well as movement.
+			if (step == 2)
+			{
+				serial.destroy(handles[5]);
+				parallel.destroy(handles[5]);
+				serial.setParent(handles[40], handles[0]);
+				parallel.setParent(handles[40], handles[0]);
+			}
+
+			serial.integrate(1.0f / 60.0f);
+			serial.updateWorldTransforms();
+			parallel.integrate(1.0f / 60.0f, pool);
+			parallel.updateWorldTransforms(pool);
+
+			int mismatches = 0;
+			for (std::size_t i = 0; i < handles.size(); ++i)
+				if (i != 5 && !sameWorld(serial, parallel, handles[i]))
+					++mismatches;
+			CHECK_EQUAL(0, mismatches);
+		}
+	}
+
+	// Children follow their parents through a parallel sweep.
+	void testChildFollowsParent()
+	{
+		TransformStore store;
+		TransformStore::Handle child = store.create();
+		TransformStore::Handle parent = store.create();
+		store.setParent(child, parent);
+		store.setPosition(child, XMVectorSet(1.0f, 0.0f, 0.0f, 1.0f));
+		store.setVelocity(parent, XMVectorSet(0.0f, 2.0f, 0.0f, 0.0f));
+
+		ThreadPool pool(2);
+		store.integrate(0.5f, pool);
+		store.updateWorldTransforms(pool);
+
+		XMFLOAT4X4 world;
+		XMStoreFloat4x4(&world, store.getWorldTransform(child));
+		CHECK_EQUAL(1.0f, world._41);
+		CHECK_EQUAL(1.0f, world._42);
+		CHECK(store.worldChanged(child));
+	}
+}
+
+int main()
+{
+	testParallelSweepsMatchSerial();
+	testChildFollowsParent();
+
+	return checkResult();
+}
@@ -0,0 +1,147 @@
+#include "Check.h"
+#include "ThreadPool.h"
+#include "Waves.h"
+#include <vector>
+
+namespace
+{
+	// The solver as it was before the height fields, tiles and vector paths:
+	// every interior point stepped every step, in plain float arithmetic.
+	class ReferenceWaves
+	{
+	public:
+		ReferenceWaves(int m, int n, float dx, float dt, float speed, float damping)
+			: mRows(m), mCols(n), mPrev(m*n, 0.0f), mCurr(m*n, 0.0f)
+		{
+			float d = damping*dt + 2.0f;
+			float e = (speed*speed)*(dt*dt) / (dx*dx);
+			mK1 = (damping*dt - 2.0f) / d;
+			mK2 = (4.0f - 8.0f*e) / d;
+			mK3 = (2.0f*e) / d;
+		}
+
+		void Step()
+		{
+			const int n = mCols;
+			for(int i = 1; i < mRows-1; ++i)
+			{
+				for(int j = 1; j < n-1; ++j)
+				{
+					mPrev[i*n+j] = mK1*mPrev[i*n+j] + mK2*mCurr[i*n+j] +
+						mK3*(mCurr[(i+1)*n+j] + mCurr[(i-1)*n+j] + mCurr[i*n+j+1] + mCurr[i*n+j-1]);
+				}
+			}
+			mPrev.swap(mCurr);
+		}
+
+		void Disturb(int i, int j, float magnitude)
+		{
+			float halfMag = 0.5f*magnitude;
+			mCurr[i*mCols+j] += magnitude;
+			mCurr[i*mCols+j+1] += halfMag;
+			mCurr[i*mCols+j-1] += halfMag;
+			mCurr[(i+1)*mCols+j] += halfMag;
+			mCurr[(i-1)*mCols+j] += halfMag;
+		}
+
+		float Height(int i)const { return mCurr[i]; }
+
+	private:
+		int mRows;
+		int mCols;
+		float mK1, mK2, mK3;
+		std::vector<float> mPrev;
+		std::vector<float> mCurr;
+	};
+
+	const int Rows = 150;
+	const int Cols = 301;
+	const float TimeStep = 0.03f;
+
+	int countMismatches(const Waves& waves, const ReferenceWaves& reference)
+	{
+		int mismatches = 0;
+		for(int i = 0; i < waves.VertexCount(); ++i)
+			if(waves.Position(i).y != reference.Height(i))
+				++mismatches;
+		return mismatches;
+	}
+
+	// Whatever the path (scalar tail, vector widths, tiles, bands on a pool,
+	// fused vertex emission) the heights match the reference bit for bit.
+	void testMatchesReference(ThreadPool* pool, bool emitVertices)
+	{
+		Waves waves(Rows, Cols, 1.0f, TimeStep, 4.0f, 0.2f);
+		ReferenceWaves reference(Rows, Cols, 1.0f, TimeStep, 4.0f, 0.2f);
+		waves.SetThreadPool(pool);
+
+		std::vector<Waves::Vertex> vertices(waves.VertexCount());
+		for(int step = 0; step < 60; ++step)
+		{
+			if(step % 20 == 0)
+			{
+				int i = 5 + step;
+				int j = 7 + 4*step;
+				waves.Disturb(i, j, 0.5f);
+				reference.Disturb(i, j, 0.5f);
+			}
+
+			if(emitVertices)
+				waves.Update(TimeStep, vertices.data());
+			else
+				waves.Update(TimeStep);
+			reference.Step();
+		}
+
+		CHECK_EQUAL(0, countMismatches(waves, reference));
+
+		if(emitVertices)
+		{
+			int mismatches = 0;
+			for(int i = 0; i < waves.VertexCount(); ++i)
+				if(vertices[i].Pos.y != reference.Height(i))
+					++mismatches;
+			CHECK_EQUAL(0, mismatches);
+		}
+	}
+
+	// Waves made without a time step step on every update, whatever the time
+	// passed and whatever the sub-stepping.
+	void testZeroTimeStepStepsEveryUpdate(bool subStepping)
+	{
+		Waves waves(Rows, Cols, 1.0f, 0.0f, 4.0f, 0.2f);
+		ReferenceWaves reference(Rows, Cols, 1.0f, 0.0f, 4.0f, 0.2f);
+		if(subStepping)
+			waves.SetSubStepping(4, 0.5);
+
+		waves.Disturb(20, 30, 0.5f);
+		reference.Disturb(20, 30, 0.5f);
+
+		std::vector<Waves::Vertex> vertices(waves.VertexCount());
+		const float frameTimes[] = { 0.0f, 0.016f, 1.0f, 0.001f };
+		for(float dt : frameTimes)
+		{
+			waves.Update(dt);
+			reference.Step();
+			waves.Update(dt, vertices.data());
+			reference.Step();
+		}
+
+		CHECK_EQUAL(0, countMismatches(waves, reference));
+	}
+}
+
+int main()
+{
+	ThreadPool pool(3);
+
+	testZeroTimeStepStepsEveryUpdate(false);
+	testZeroTimeStepStepsEveryUpdate(true);
+
+	testMatchesReference(nullptr, false);
+	testMatchesReference(nullptr, true);
+	testMatchesReference(&pool, false);
+	testMatchesReference(&pool, true);
+
+	return checkResult();
+}